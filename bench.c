@@ -0,0 +1,263 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "void_array.h"
+#include "void_ring.h"
+
+#define RING_CAPACITY 1024
+#define RING_BATCH 32
+#define RING_THREADS 2
+
+struct message {
+    uint64_t seq;
+    uint64_t payload;
+};
+
+struct ring_job {
+    struct void_ring* vring;
+    struct void_array* varray;
+    pthread_mutex_t* lock;
+    size_t n;
+    size_t batch;
+    uint64_t checksum;
+};
+
+static double
+now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int
+cmp_double(const void* a, const void* b)
+{
+    double da = *(const double*)a, db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+static void*
+ring_producer(void* arg)
+{
+    struct ring_job* job = (struct ring_job*)arg;
+    struct message batch[RING_BATCH];
+    size_t sent = 0;
+
+    while (sent < job->n) {
+        size_t n = job->n - sent < job->batch ? job->n - sent : job->batch;
+        size_t pushed = 0;
+        for (size_t i = 0; i < n; i++) {
+            batch[i].seq = sent + i;
+            batch[i].payload = (sent + i) * 7;
+        }
+        while (pushed < n) {
+            size_t k = vring_push_n(job->vring, batch + pushed, n - pushed);
+            if (!k) sched_yield();
+            pushed += k;
+        }
+        sent += n;
+    }
+    return NULL;
+}
+
+static void*
+ring_consumer(void* arg)
+{
+    struct ring_job* job = (struct ring_job*)arg;
+    struct message batch[RING_BATCH];
+    size_t received = 0;
+
+    while (received < job->n) {
+        size_t k = vring_pop_n(job->vring, batch, job->n - received < job->batch ? job->n - received : job->batch);
+        if (!k) sched_yield();
+        for (size_t i = 0; i < k; i++) {
+            job->checksum += batch[i].payload;
+        }
+        received += k;
+    }
+    return NULL;
+}
+
+static void*
+mutex_producer(void* arg)
+{
+    struct ring_job* job = (struct ring_job*)arg;
+    for (size_t i = 0; i < job->n; i++) {
+        struct message msg = { i, i * 7 };
+        pthread_mutex_lock(job->lock);
+        varr_add(job->varray, &msg, 1);
+        pthread_mutex_unlock(job->lock);
+    }
+    return NULL;
+}
+
+static void*
+mutex_consumer(void* arg)
+{
+    struct ring_job* job = (struct ring_job*)arg;
+    size_t received = 0;
+    while (received < job->n) {
+        struct message msg;
+        int found = 0;
+        pthread_mutex_lock(job->lock);
+        if (job->varray->size) {
+            memcpy(&msg, varr_get(job->varray, 0), sizeof(msg));
+            varr_remove(job->varray, 0, 1);
+            found = 1;
+        }
+        pthread_mutex_unlock(job->lock);
+        if (found) {
+            job->checksum += msg.payload;
+            received++;
+        } else {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void
+bench_ring_throughput(const char* name, int mode, size_t threads, size_t batch, size_t n)
+{
+    struct void_ring vring;
+    pthread_t producers[RING_THREADS], consumers[RING_THREADS];
+    struct ring_job jobs[RING_THREADS * 2];
+    uint64_t checksum = 0;
+    double start, elapsed;
+
+    vring_init(&vring, RING_CAPACITY, sizeof(struct message), mode);
+    start = now_ns();
+    for (size_t t = 0; t < threads; t++) {
+        jobs[t].vring = jobs[threads + t].vring = &vring;
+        jobs[t].n = jobs[threads + t].n = n / threads;
+        jobs[t].batch = jobs[threads + t].batch = batch;
+        jobs[t].checksum = jobs[threads + t].checksum = 0;
+        pthread_create(consumers + t, NULL, ring_consumer, jobs + threads + t);
+        pthread_create(producers + t, NULL, ring_producer, jobs + t);
+    }
+    for (size_t t = 0; t < threads; t++) {
+        pthread_join(producers[t], NULL);
+        pthread_join(consumers[t], NULL);
+        checksum += jobs[threads + t].checksum;
+    }
+    elapsed = now_ns() - start;
+    assert(checksum == threads * 7 * ((n / threads) * (n / threads - 1) / 2));
+    printf("%-28s%12zu%14.2f%12.2f\n", name, n, n / elapsed * 1e3, elapsed / n);
+    vring_free(&vring);
+}
+
+static void
+bench_mutex_throughput(size_t n)
+{
+    struct void_array varray;
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    pthread_t producer, consumer;
+    struct ring_job jobs[2];
+    double start, elapsed;
+
+    varr_init(&varray, RING_CAPACITY, sizeof(struct message), NULL);
+    jobs[0].varray = jobs[1].varray = &varray;
+    jobs[0].lock = jobs[1].lock = &lock;
+    jobs[0].n = jobs[1].n = n;
+    jobs[1].checksum = 0;
+    start = now_ns();
+    pthread_create(&consumer, NULL, mutex_consumer, jobs + 1);
+    pthread_create(&producer, NULL, mutex_producer, jobs);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+    elapsed = now_ns() - start;
+    assert(jobs[1].checksum == 7 * (n * (n - 1) / 2));
+    printf("%-28s%12zu%14.2f%12.2f\n", "mutex varr_add/remove", n, n / elapsed * 1e3, elapsed / n);
+    varr_free(&varray);
+}
+
+static void*
+ping_pong_echo(void* arg)
+{
+    struct void_ring* rings = (struct void_ring*)arg;
+    struct message msg;
+    for (;;) {
+        while (vring_pop(rings, &msg) != VRING_SUCCESS) sched_yield();
+        while (vring_push(rings + 1, &msg) != VRING_SUCCESS) sched_yield();
+        if (msg.payload == UINT64_MAX) break;
+    }
+    return NULL;
+}
+
+static void
+bench_ring_latency(size_t round_trips)
+{
+    struct void_ring rings[2];
+    struct void_array samples;
+    struct message msg = { 0, 0 };
+    pthread_t echo;
+    double total = 0;
+
+    vring_init(rings, RING_CAPACITY, sizeof(struct message), VRING_SPSC);
+    vring_init(rings + 1, RING_CAPACITY, sizeof(struct message), VRING_SPSC);
+    varr_init(&samples, round_trips, sizeof(double), NULL);
+    pthread_create(&echo, NULL, ping_pong_echo, rings);
+    for (size_t i = 0; i <= round_trips; i++) {
+        double start = now_ns(), sample;
+        msg.seq = i;
+        msg.payload = i == round_trips ? UINT64_MAX : i;
+        while (vring_push(rings, &msg) != VRING_SUCCESS) sched_yield();
+        while (vring_pop(rings + 1, &msg) != VRING_SUCCESS) sched_yield();
+        sample = now_ns() - start;
+        if (i < round_trips) {
+            varr_add(&samples, &sample, 1);
+            total += sample;
+        }
+    }
+    pthread_join(echo, NULL);
+    qsort(samples.value_bytes, samples.size, sizeof(double), cmp_double);
+    printf("%-28s%12zu%14.2f%12.2f%12.2f\n", "spsc ping-pong round trip", round_trips,
+            total / round_trips,
+            *(const double*)varr_get(&samples, samples.size / 2),
+            *(const double*)varr_get(&samples, samples.size * 99 / 100));
+    varr_free(&samples);
+    vring_free(rings);
+    vring_free(rings + 1);
+}
+
+int
+main(int argc, char** argv)
+{
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+
+    printf("%-28s%12s%14s%12s\n", "throughput", "messages", "Mmsg/s", "ns/msg");
+    bench_ring_throughput("spsc", VRING_SPSC, 1, 1, n);
+    bench_ring_throughput("spsc batch", VRING_SPSC, 1, RING_BATCH, n);
+    bench_ring_throughput("mpmc 1x1", VRING_MPMC, 1, 1, n);
+    bench_ring_throughput("mpmc 2x2 batch", VRING_MPMC, RING_THREADS, RING_BATCH, n);
+    bench_mutex_throughput(n / 10);
+
+    printf("\n%-28s%12s%14s%12s%12s\n", "latency", "round trips", "mean ns", "p50 ns", "p99 ns");
+    bench_ring_latency(n / 100 ? n / 100 : 1);
+
+    return 0;
+}
@@ -0,0 +1,552 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#define _GNU_SOURCE
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "void_alloc.h"
+#include "void_array.h"
+#include "void_dict.h"
+#include "void_flatmap.h"
+#include "void_packed.h"
+#include "void_vector.h"
+
+#define BENCH_MIN_SIZE 1000
+#define BENCH_CHECK_EVERY 256
+#define BENCH_ZIPF_THETA 0.99
+/* odd and coprime to powers of ten, maps zipf ranks onto scattered keys */
+#define BENCH_SCATTER 2654435761ull
+
+enum bench_dist { DIST_SEQUENTIAL, DIST_UNIFORM, DIST_ZIPF };
+static const char* dist_names[] = { "sequential", "uniform", "zipf" };
+
+enum bench_counter { COUNTER_CACHE_MISSES, COUNTER_BRANCH_MISSES, COUNTERS };
+
+struct bench_run {
+    double start;
+    double budget_ns;
+    size_t allocated;
+    size_t ops;
+    int out_of_time;
+};
+
+static int counter_fds[COUNTERS] = { -1, -1 };
+static double budget_ns = 1e9;
+static volatile uint64_t sink;
+
+/* Counting allocator, so allocations of all containers are attributed to the running workload */
+static size_t bytes_allocated = 0;
+static size_t bytes_live = 0;
+
+static void*
+count_alloc(void* ctx, size_t size)
+{
+    (void)ctx;
+    bytes_allocated += size;
+    bytes_live += size;
+    return valloc_stdlib.alloc_fn(valloc_stdlib.ctx, size);
+}
+
+static void*
+count_realloc(void* ctx, void* ptr, size_t old_size, size_t new_size)
+{
+    (void)ctx;
+    if (new_size > old_size) {
+        bytes_allocated += new_size - old_size;
+    }
+    bytes_live += new_size - old_size;
+    return valloc_stdlib.realloc_fn(valloc_stdlib.ctx, ptr, old_size, new_size);
+}
+
+static void
+count_free(void* ctx, void* ptr, size_t size)
+{
+    (void)ctx;
+    bytes_live -= size;
+    valloc_stdlib.free_fn(valloc_stdlib.ctx, ptr, size);
+}
+
+static const struct void_allocator count_allocator = { count_alloc, count_realloc, count_free, NULL };
+
+static double
+now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint64_t
+xorshift(uint64_t* state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ull;
+}
+
+static void
+counters_open()
+{
+#ifdef __linux__
+    const uint64_t configs[COUNTERS] = { PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+    for (int c = 0; c < COUNTERS; c++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = configs[c];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        counter_fds[c] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+#endif
+}
+
+static void
+counters_toggle(int enable)
+{
+#ifdef __linux__
+    for (int c = 0; c < COUNTERS; c++) {
+        if (counter_fds[c] >= 0) {
+            if (enable) ioctl(counter_fds[c], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counter_fds[c], enable ? PERF_EVENT_IOC_ENABLE : PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+#else
+    (void)enable;
+#endif
+}
+
+static int
+counter_read(int c, uint64_t* value)
+{
+#ifdef __linux__
+    return counter_fds[c] >= 0 && read(counter_fds[c], value, sizeof(*value)) == sizeof(*value);
+#else
+    (void)c;
+    (void)value;
+    return 0;
+#endif
+}
+
+static void
+run_begin(struct bench_run* run)
+{
+    run->allocated = bytes_allocated;
+    run->ops = 0;
+    run->out_of_time = 0;
+    run->budget_ns = budget_ns;
+    counters_toggle(1);
+    run->start = now_ns();
+}
+
+/* Returns whether op `i` is to be run, stops workloads exceeding the time budget */
+static int
+run_next(struct bench_run* run, size_t i)
+{
+    if (i % BENCH_CHECK_EVERY == 0 && i && now_ns() - run->start > run->budget_ns) {
+        run->out_of_time = 1;
+        return 0;
+    }
+    return 1;
+}
+
+/* Prints one JSON line per measurement, missing counters are null */
+static void
+run_end(struct bench_run* run, size_t ops, const char* container, const char* workload,
+        enum bench_dist dist, size_t size)
+{
+    double elapsed = now_ns() - run->start;
+    uint64_t value;
+
+    counters_toggle(0);
+    run->ops = ops;
+    printf("{\"container\":\"%s\",\"workload\":\"%s\",\"dist\":\"%s\",\"size\":%zu,\"ops\":%zu,"
+            "\"truncated\":%s,\"ns_per_op\":%.3f,\"bytes_per_op\":%.3f,\"bytes_per_elem\":%.3f",
+            container, workload, dist_names[dist], size, ops, run->out_of_time ? "true" : "false",
+            ops ? elapsed / ops : 0.0,
+            ops ? (double)(bytes_allocated - run->allocated) / ops : 0.0,
+            size ? (double)bytes_live / size : 0.0);
+    if (ops && counter_read(COUNTER_CACHE_MISSES, &value)) {
+        printf(",\"cache_misses_per_op\":%.4f", (double)value / ops);
+    } else {
+        printf(",\"cache_misses_per_op\":null");
+    }
+    if (ops && counter_read(COUNTER_BRANCH_MISSES, &value)) {
+        printf(",\"branch_misses_per_op\":%.4f", (double)value / ops);
+    } else {
+        printf(",\"branch_misses_per_op\":null");
+    }
+    printf("}\n");
+    fflush(stdout);
+}
+
+/* Fills `fill` with the keys 1..n in insertion order and `stream` with n keys to look up */
+static void
+make_keys(enum bench_dist dist, size_t n, uint64_t* fill, uint64_t* stream)
+{
+    uint64_t state = 0x9E3779B97F4A7C15ull ^ n;
+
+    for (size_t i = 0; i < n; i++) {
+        fill[i] = i + 1;
+    }
+    if (dist != DIST_SEQUENTIAL) {
+        for (size_t i = n - 1; i > 0; i--) {
+            size_t j = xorshift(&state) % (i + 1);
+            uint64_t tmp = fill[i];
+            fill[i] = fill[j];
+            fill[j] = tmp;
+        }
+    }
+
+    if (dist == DIST_ZIPF) {
+        /* Gray et al. "Quickly Generating Billion-Record Synthetic Databases" */
+        double zetan = 0, zeta2 = 1 + pow(0.5, BENCH_ZIPF_THETA);
+        double alpha = 1 / (1 - BENCH_ZIPF_THETA), eta;
+        for (size_t i = 1; i <= n; i++) {
+            zetan += 1 / pow((double)i, BENCH_ZIPF_THETA);
+        }
+        eta = (1 - pow(2.0 / n, 1 - BENCH_ZIPF_THETA)) / (1 - zeta2 / zetan);
+        for (size_t i = 0; i < n; i++) {
+            double u = (double)(xorshift(&state) >> 11) / (double)(1ull << 53);
+            double uz = u * zetan;
+            uint64_t rank;
+            if (uz < 1) rank = 0;
+            else if (uz < zeta2) rank = 1;
+            else rank = (uint64_t)(n * pow(eta * u - eta + 1, alpha));
+            if (rank >= n) rank = n - 1;
+            stream[i] = (rank * BENCH_SCATTER) % n + 1;
+        }
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            stream[i] = dist == DIST_SEQUENTIAL ? i + 1 : xorshift(&state) % n + 1;
+        }
+    }
+}
+
+static void
+bench_varr(enum bench_dist dist, size_t n, const uint64_t* fill, const uint64_t* stream)
+{
+    struct void_array varray;
+    struct bench_run run;
+    uint64_t sum = 0;
+    size_t i;
+
+    /* sequential appends or inserts at positions drawn from the distribution */
+    varr_init(&varray, 1, sizeof(uint64_t), NULL);
+    run_begin(&run);
+    for (i = 0; i < n && run_next(&run, i); i++) {
+        if (dist == DIST_SEQUENTIAL || !varray.size) {
+            varr_add(&varray, fill + i, 1);
+        } else {
+            varr_insert(&varray, stream[i] % varray.size, fill + i, 1);
+        }
+    }
+    run_end(&run, i, "void_array", "insert", dist, varray.size);
+    if (varray.size < n) {
+        varr_add(&varray, fill + varray.size, n - varray.size);
+    }
+
+    run_begin(&run);
+    for (i = 0; i < n && run_next(&run, i); i++) {
+        sum += *(const uint64_t*)varr_get(&varray, stream[i] - 1);
+    }
+    run_end(&run, i, "void_array", "lookup_hit", dist, varray.size);
+
+    run_begin(&run);
+    for (i = 0; i < n && run_next(&run, i); i++) {
+        sum += varr_get(&varray, n + stream[i]) == NULL;
+    }
+    run_end(&run, i, "void_array", "lookup_miss", dist, varray.size);
+
+    run_begin(&run);
+    for (i = 0; i < n && run_next(&run, i); i++) {
+        varr_remove(&varray, stream[i] - 1, 1);
+        varr_add(&varray, fill + i, 1);
+    }
+    run_end(&run, i, "void_array", "delete_churn", dist, varray.size);
+
+    run_begin(&run);
+    for (i = 0; i < varray.size && run_next(&run, i); i++) {
+        sum += *(const uint64_t*)varr_get(&varray, i);
+    }
+    run_end(&run, i, "void_array", "iterate", dist, varray.size);
+
+    sink += sum;
+    varr_free(&varray);
+}
+
+static void
+bench_vvec(enum bench_dist dist, size_t n, const uint64_t* fill, const uint64_t* stream)
+{
+    vvec vec;
+    struct bench_run run;
+    uint64_t sum = 0;
+    size_t i;
+
+    vvec_init(&vec, sizeof(uint64_t));
+    run_begin(&run);
+    for (i = 0; i < n && run_next(&run, i); i++) {
+        if (dist == DIST_SEQUENTIAL) {
+            *(uint64_t*)vvec_emplace_back(&vec) = fill[i];
+        } else {
+            vvec_insert(&vec, stream[i] % (vec.count + 1), (void*)(fill + i), 1);
+        }
+    }
+    run_end(&run, i, "void_vector", "insert", dist, vec.count);
+    if (vec.count < n) {
+        vvec_push_back(&vec, fill + vec.count, n - vec.count);
+    }
+
+    run_begin(&run);
+    for (i = 0; i < n && run_next(&run, i); i++) {
+        sum += *(const uint64_t*)vvec_at(&vec, stream[i] - 1);
+    }
+    run_end(&run, i, "void_vector", "lookup_hit", dist, vec.count);
+
+    run_begin(&run);
+    for (i = 0; i < n && run_next(&run, i); i++) {
+        vvec_erase_idx(&vec, stream[i] - 1);
+        vvec_push_back(&vec, fill + i, 1);
+    }
+    run_end(&run, i, "void_vector", "delete_churn", dist, vec.count);
+
+    run_begin(&run);
+    for (i = 0; i < n && run_next(&run, i); i++) {
+        vvec_swap_remove(&vec, stream[i] - 1);
+        vvec_push_back(&vec, fill + i, 1);
+    }
+    run_end(&run, i, "void_vector", "swap_churn", dist, vec.count);
+
+    run_begin(&run);
+    for (i = 0; i < vec.count && run_next(&run, i); i++) {
+        sum += *(const uint64_t*)vvec_at(&vec, i);
+    }
+    run_end(&run, i, "void_vector", "iterate", dist, vec.count);
+
+    sink += sum;
+    vvec_free(&vec);
+}
+
+static void
+bench_vdict(enum bench_dist dist, size_t n, const uint64_t* fill, const uint64_t* stream)
+{
+    struct void_dict vdict;
+    struct bench_run run;
+    uint64_t* keys;
+    uint64_t sum = 0;
+    size_t i;
+
+    /* twice the keys as hash pool to keep linear probing short */
+    vdict_init(&vdict, n * 2, sizeof(uint64_t), sizeof(uint64_t), NULL);
+    run_begin(&run);
+    for (i = 0; i < n && run_next(&run, i); i++) {
+        vdict_add_pair(&vdict, (void*)(fill + i), (void*)(fill + i));
+    }
+    run_end(&run, i, "void_dict", "insert", dist, vdict.size);
+
+    run_begin(&run);
+    for (i = 0; i < n && run_next(&run, i); i++) {
+        const uint64_t* value = (const uint64_t*)vdict_get_value(&vdict, stream + i);
+        sum += value ? *value : 0;
+    }
+    run_end(&run, i, "void_dict", "lookup_hit", dist, vdict.size);
+
+    run_begin(&run);
+    for (i = 0; i < n && run_next(&run, i); i++) {
+        uint64_t key = n + stream[i];
+        sum += vdict_get_value(&vdict, &key) == NULL;
+    }
+    run_end(&run, i, "void_dict", "lookup_miss", dist, vdict.size);
+
+    run_begin(&run);
+    for (i = 0; i < n && run_next(&run, i); i++) {
+        if (vdict_del_pair(&vdict, stream + i) == VDICT_SUCCESS) {
+            vdict_add_pair(&vdict, (void*)(stream + i), (void*)(stream + i));
+        }
+    }
+    run_end(&run, i, "void_dict", "delete_churn", dist, vdict.size);
+
+    keys = (uint64_t*)malloc(sizeof(uint64_t) * (vdict.size ? vdict.size : 1));
+    run_begin(&run);
+    vdict_get_keys(&vdict, keys);
+    for (i = 0; i < vdict.size; i++) {
+        const uint64_t* value = (const uint64_t*)vdict_get_value(&vdict, keys + i);
+        sum += value ? *value : 0;
+    }
+    run_end(&run, i, "void_dict", "iterate", dist, vdict.size);
+
+    sink += sum;
+    free(keys);
+    vdict_free(&vdict);
+}
+
+static int
+cmp_u64(const void* a, const void* b)
+{
+    uint64_t ka = *(const uint64_t*)a, kb = *(const uint64_t*)b;
+    return (ka > kb) - (ka < kb);
+}
+
+/* Plain binary search over the sorted keys is the baseline of `vfmap_get` */
+static void
+bench_vfmap(enum bench_dist dist, size_t n, const uint64_t* fill, const uint64_t* stream)
+{
+    struct void_flatmap vfmap;
+    struct bench_run run;
+    uint64_t low, high;
+    uint64_t sum = 0;
+    size_t i, first;
+
+    vfmap_init(&vfmap, sizeof(uint64_t), sizeof(uint64_t), NULL);
+    run_begin(&run);
+    vfmap_build(&vfmap, fill, fill, n);
+    run_end(&run, n, "void_flatmap", "insert", dist, vfmap.keys.size);
+
+    run_begin(&run);
+    for (i = 0; i < n && run_next(&run, i); i++) {
+        const uint64_t* value = (const uint64_t*)vfmap_get(&vfmap, stream + i);
+        sum += value ? *value : 0;
+    }
+    run_end(&run, i, "void_flatmap", "lookup_hit", dist, vfmap.keys.size);
+
+    run_begin(&run);
+    for (i = 0; i < n && run_next(&run, i); i++) {
+        const uint64_t* key = (const uint64_t*)bsearch(stream + i, varr_data(&vfmap.keys), vfmap.keys.size,
+                                                       sizeof(uint64_t), cmp_u64);
+        sum += key ? *(const uint64_t*)varr_get(&vfmap.values, key - (const uint64_t*)varr_data(&vfmap.keys)) : 0;
+    }
+    run_end(&run, i, "bsearch", "lookup_hit", dist, vfmap.keys.size);
+
+    run_begin(&run);
+    for (i = 0; i < n && run_next(&run, i); i++) {
+        uint64_t key = n + stream[i];
+        sum += vfmap_get(&vfmap, &key) == NULL;
+    }
+    run_end(&run, i, "void_flatmap", "lookup_miss", dist, vfmap.keys.size);
+
+    /* ranges of 16 keys starting at the looked up key */
+    run_begin(&run);
+    for (i = 0; i < n && run_next(&run, i); i++) {
+        low = stream[i];
+        high = low + 15;
+        sum += vfmap_range(&vfmap, &low, &high, &first) + first;
+    }
+    run_end(&run, i, "void_flatmap", "range", dist, vfmap.keys.size);
+
+    run_begin(&run);
+    for (i = 0; i < vfmap.keys.size && run_next(&run, i); i++) {
+        sum += *(const uint64_t*)varr_get(&vfmap.values, i);
+    }
+    run_end(&run, i, "void_flatmap", "iterate", dist, vfmap.keys.size);
+
+    sink += sum;
+    vfmap_free(&vfmap);
+}
+
+/* Sequential keys become delta blocks, shuffled keys frame of reference blocks */
+static void
+bench_vpack(enum bench_dist dist, size_t n, const uint64_t* fill, const uint64_t* stream)
+{
+    struct void_packed vpack;
+    struct bench_run run;
+    uint64_t out[VPACK_BLOCK];
+    uint64_t value, sum = 0;
+    size_t i;
+
+    vpack_init(&vpack, 1);
+    run_begin(&run);
+    for (i = 0; i < n && run_next(&run, i); i++) {
+        vpack_add(&vpack, fill + i, 1);
+    }
+    run_end(&run, i, "void_packed", "insert", dist, vpack.size);
+    if (vpack.size < n) {
+        vpack_add(&vpack, fill + vpack.size, n - vpack.size);
+    }
+
+    run_begin(&run);
+    for (i = 0; i < n && run_next(&run, i); i++) {
+        vpack_get(&vpack, stream[i] - 1, &value);
+        sum += value;
+    }
+    run_end(&run, i, "void_packed", "lookup_hit", dist, vpack.size);
+
+    /* whole blocks, one op per decoded value */
+    run_begin(&run);
+    for (i = 0; i + VPACK_BLOCK <= vpack.size && run_next(&run, i); i += VPACK_BLOCK) {
+        vpack_decode(&vpack, i, VPACK_BLOCK, out);
+        sum += out[VPACK_BLOCK - 1];
+    }
+    run_end(&run, i, "void_packed", "decode", dist, vpack.size);
+
+    sink += sum;
+    vpack_free(&vpack);
+}
+
+int
+main(int argc, char** argv)
+{
+    size_t max_size = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    uint64_t* fill;
+    uint64_t* stream;
+
+    if (argc > 2) {
+        budget_ns = strtod(argv[2], NULL) * 1e9;
+    }
+    if (max_size < BENCH_MIN_SIZE) {
+        max_size = BENCH_MIN_SIZE;
+    }
+    fill = (uint64_t*)malloc(sizeof(uint64_t) * max_size);
+    stream = (uint64_t*)malloc(sizeof(uint64_t) * max_size);
+    if (!fill || !stream) {
+        fprintf(stderr, "not enough memory for %zu keys\n", max_size);
+        return 1;
+    }
+    counters_open();
+    valloc_set_default(&count_allocator);
+
+    for (size_t n = BENCH_MIN_SIZE; n <= max_size; n *= 10) {
+        for (int dist = DIST_SEQUENTIAL; dist <= DIST_ZIPF; dist++) {
+            make_keys((enum bench_dist)dist, n, fill, stream);
+            bench_varr((enum bench_dist)dist, n, fill, stream);
+            bench_vvec((enum bench_dist)dist, n, fill, stream);
+            bench_vdict((enum bench_dist)dist, n, fill, stream);
+            bench_vfmap((enum bench_dist)dist, n, fill, stream);
+            bench_vpack((enum bench_dist)dist, n, fill, stream);
+        }
+    }
+
+    valloc_set_default(NULL);
+    free(fill);
+    free(stream);
+    return 0;
+}
@@ -22,12 +22,62 @@
 #include <string.h>
 #include <time.h>
 #include <limits.h>
+#include <unistd.h>
+#include <pthread.h>
 
+#include "void_alloc.h"
 #include "void_array.h"
+#include "void_array_concurrent.h"
+#include "void_array_mmap.h"
+#include "void_bitset.h"
+#include "void_cow.h"
 #include "void_dict.h"
+#include "void_flatmap.h"
+#include "void_heap.h"
+#include "void_packed.h"
+#include "void_parallel.h"
+#include "void_ring.h"
+#include "void_slotmap.h"
+#include "void_table.h"
+#include "void_telemetry.h"
+#include "void_vector.h"
 
 #define INIT_CAPACITY 5
 
+/* allocations the failing allocator grants before it returns NULL */
+static long alloc_budget;
+
+static void*
+failing_alloc(void* ctx, size_t size)
+{
+    (void)ctx;
+    return alloc_budget-- > 0 ? calloc(1, size) : NULL;
+}
+
+static void*
+failing_realloc(void* ctx, void* ptr, size_t old_size, size_t new_size)
+{
+    unsigned char* grown;
+    (void)ctx;
+    if (alloc_budget-- <= 0) {
+        return NULL;
+    }
+    grown = realloc(ptr, new_size);
+    if (grown && new_size > old_size) {
+        memset(grown + old_size, 0, new_size - old_size);
+    }
+    return grown;
+}
+
+static void
+failing_free(void* ctx, void* ptr, size_t size)
+{
+    (void)ctx;
+    (void)size;
+    free(ptr);
+}
+
+static const struct void_allocator failing_allocator = { failing_alloc, failing_realloc, failing_free, NULL };
 
 static void 
 void_array_test() 
@@ -159,6 +209,1243 @@ void_dict_test() {
     printf("%25s%15s\n", "vdict_free", "success");
 }
 
+static size_t range_free_calls = 0;
+static size_t range_free_values = 0;
+
+static void
+count_range_free(void* base, size_t n, size_t stride) {
+    range_free_calls++;
+    range_free_values += n;
+    varr_range_free_ptrs(base, n, stride);
+}
+
+static void
+void_range_free_test() {
+    struct void_array varray;
+    struct void_dict vdict;
+
+    assert(varr_init(&varray, INIT_CAPACITY, sizeof(int*), NULL) == VARR_SUCCESS);
+    varr_set_range_free_fn(&varray, count_range_free);
+    for (int i = 0; i < INIT_CAPACITY * 2; i++) {
+        int* owned = malloc(sizeof(int));
+        *owned = i;
+        assert(varr_add(&varray, &owned, 1) == VARR_SUCCESS);
+    }
+    assert(varr_remove(&varray, 1, 3) == VARR_SUCCESS);
+    assert(range_free_calls == 1 && range_free_values == 3);
+    assert(**(int**)varr_get(&varray, 1) == 4);
+    varr_free(&varray);
+    assert(range_free_calls == 2 && range_free_values == INIT_CAPACITY * 2);
+    assert(varray.range_free_fn == NULL);
+    printf("%25s%15s\n", "varr_set_range_free_fn", "success");
+
+    range_free_calls = range_free_values = 0;
+    assert(vdict_init(&vdict, 7, sizeof(int), sizeof(int*), NULL) == VDICT_SUCCESS);
+    vdict_set_range_free_fn(&vdict, count_range_free);
+    for (int i = 1; i <= 4; i++) {
+        int* owned = malloc(sizeof(int));
+        *owned = i;
+        assert(vdict_add_pair(&vdict, &i, &owned) == VDICT_SUCCESS);
+    }
+    assert(vdict_clear(&vdict) == VDICT_SUCCESS);
+    assert(range_free_values == 4 && range_free_calls <= 4);
+    vdict_free(&vdict);
+    assert(vdict.range_free_fn == NULL);
+    printf("%25s%15s\n", "vdict_set_range_free_fn", "success");
+}
+
+#if VARR_INLINE_BYTES > 0 && VDICT_INLINE_BYTES > 0
+static void
+void_small_buffer_test() {
+    struct void_array varray, varray_copy;
+    struct void_dict vdict, vdict_copy;
+    int values[VARR_INLINE_BYTES / sizeof(int) + 1];
+    int key = 7, value = 49;
+
+    for (size_t i = 0; i < sizeof(values) / sizeof(int); i++) {
+        values[i] = (int)i;
+    }
+
+    assert(varr_init(&varray, VARR_INLINE_BYTES / sizeof(int) / 4, sizeof(int), NULL) == VARR_SUCCESS);
+    assert(varray.is_inline);
+    assert(varray.value_bytes == varray.inline_bytes.bytes);
+    assert(varr_add(&varray, values, VARR_INLINE_BYTES / sizeof(int)) == VARR_SUCCESS);
+    assert(varray.is_inline);
+    /* copies of small buffer arrays don't share storage with the original */
+    memcpy(&varray_copy, &varray, sizeof(struct void_array));
+    assert(varr_get(&varray_copy, 3) == varray_copy.inline_bytes.bytes + sizeof(int) * 3);
+    assert(varr_remove(&varray_copy, 0, 1) == VARR_SUCCESS);
+    assert(varray_copy.value_bytes == varray_copy.inline_bytes.bytes);
+    assert(*(int*)varr_get(&varray, 0) == 0 && *(int*)varr_get(&varray_copy, 0) == 1);
+    printf("%25s%15s\n", "varr small buffer", "success");
+
+    assert(varr_add(&varray, values + VARR_INLINE_BYTES / sizeof(int), 1) == VARR_SUCCESS);
+    assert(!varray.is_inline);
+    assert(!memcmp(varray.value_bytes, values, sizeof(values)));
+    varr_free(&varray);
+    varr_free(&varray_copy);
+    assert(varray_copy.value_bytes == NULL);
+    printf("%25s%15s\n", "varr small buffer spill", "success");
+
+    assert(vdict_init(&vdict, 4, sizeof(int), sizeof(int), NULL) == VDICT_SUCCESS);
+    assert(vdict.is_inline);
+    assert(vdict_add_pair(&vdict, &key, &value) == VDICT_SUCCESS);
+    memcpy(&vdict_copy, &vdict, sizeof(struct void_dict));
+    memset(&vdict, 0, sizeof(struct void_dict));
+    assert(*(int*)vdict_get_value(&vdict_copy, &key) == value);
+    assert(vdict_del_pair(&vdict_copy, &key) == VDICT_SUCCESS);
+    assert(vdict_get_value(&vdict_copy, &key) == NULL);
+    vdict_free(&vdict_copy);
+    printf("%25s%15s\n", "vdict small buffer", "success");
+}
+#endif
+
+static void
+void_alloc_test() {
+    struct void_arena arena;
+    struct void_pool pool;
+    struct void_array varray;
+    struct void_dict vdict;
+    unsigned values[INIT_CAPACITY * 4];
+
+    for (unsigned i = 0; i < INIT_CAPACITY * 4; i++) {
+        values[i] = i * 3;
+    }
+
+    assert(varena_init(&arena, 256) == VALLOC_SUCCESS);
+    assert(varr_init_alloc(&varray, INIT_CAPACITY, sizeof(unsigned), NULL, &arena.allocator) == VARR_SUCCESS);
+    assert(varray.allocator == &arena.allocator);
+    assert(varr_add(&varray, values, INIT_CAPACITY * 4) == VARR_SUCCESS);
+    assert(!memcmp(varray.value_bytes, values, sizeof(values)));
+    assert(arena.head != NULL);
+    varr_free(&varray);
+    assert(varray.allocator == NULL);
+    varena_reset(&arena);
+    assert(arena.head->used == 0);
+    varena_free(&arena);
+    assert(arena.head == NULL);
+    printf("%25s%15s\n", "varena", "success");
+
+    assert(vpool_init(&pool, 1024) == VALLOC_SUCCESS);
+    assert(varr_init_alloc(&varray, INIT_CAPACITY, sizeof(unsigned), NULL, &pool.allocator) == VARR_SUCCESS);
+    assert(varr_add(&varray, values, INIT_CAPACITY * 4) == VARR_SUCCESS);
+    assert(!memcmp(varray.value_bytes, values, sizeof(values)));
+    varr_shrink(&varray);
+    assert(!memcmp(varray.value_bytes, values, sizeof(values)));
+    varr_free(&varray);
+    assert(vdict_init_alloc(&vdict, 7, sizeof(unsigned), sizeof(unsigned), NULL, &pool.allocator) == VDICT_SUCCESS);
+    assert(vdict_add_pair(&vdict, values + 1, values + 2) == VDICT_SUCCESS);
+    assert(*(unsigned*)vdict_get_value(&vdict, values + 1) == values[2]);
+    vdict_free(&vdict);
+    vpool_free(&pool);
+    printf("%25s%15s\n", "vpool", "success");
+
+    valloc_set_default(&valloc_stdlib);
+    assert(valloc_default() == &valloc_stdlib);
+    valloc_set_default(NULL);
+    assert(valloc_default() == &valloc_stdlib);
+    printf("%25s%15s\n", "valloc_set_default", "success");
+
+    /* an array without memory gets it on the next addition */
+    valloc_set_default(&failing_allocator);
+    alloc_budget = 0;
+    assert(varr_init(&varray, 64, sizeof(unsigned), NULL) == VARR_ERROR);
+    assert(varray.capacity == 0);
+    alloc_budget = 1;
+    assert(varr_add(&varray, values, 3) == VARR_SUCCESS);
+    assert(varray.capacity >= 3 && !memcmp(varr_data(&varray), values, sizeof(unsigned) * 3));
+    /* more doublings than bits saturate and fail instead of shifting out of range */
+    alloc_budget = 0;
+    varr_expand(&varray, sizeof(unsigned long) * 8 + 1);
+    assert(varray.capacity >= 3 && varray.capacity < 64);
+    varr_free(&varray);
+    valloc_set_default(NULL);
+    assert(varr_init(&varray, 0, sizeof(unsigned), NULL) == VARR_SUCCESS);
+    assert(varr_add(&varray, values, 3) == VARR_SUCCESS);
+    assert(*(unsigned*)varr_get(&varray, 2) == values[2]);
+    varr_free(&varray);
+    printf("%25s%15s\n", "varr_init - no memory", "success");
+}
+
+static void
+void_ring_test() {
+    struct void_ring vring;
+    int values[INIT_CAPACITY * 2];
+    int out[INIT_CAPACITY * 2];
+    int value = 42;
+
+    for (int i = 0; i < INIT_CAPACITY * 2; i++) {
+        values[i] = i + 1;
+    }
+
+    for (int mode = VRING_SPSC; mode <= VRING_MPMC; mode++) {
+        assert(vring_init(&vring, INIT_CAPACITY, sizeof(int), mode) == VRING_SUCCESS);
+        assert(vring.storage.capacity == 8);
+        assert(vring_pop(&vring, out) == (VRING_ERROR ^ VRING_EMPTY));
+
+        assert(vring_push_n(&vring, values, INIT_CAPACITY * 2) == 8);
+        assert(vring_size(&vring) == 8);
+        assert(vring_push(&vring, &value) == (VRING_ERROR ^ VRING_FULL));
+        assert(vring_pop_n(&vring, out, 3) == 3);
+        assert(!memcmp(out, values, sizeof(int) * 3));
+
+        /* wraps around the end of the storage */
+        assert(vring_push_n(&vring, values + 8, 2) == 2);
+        assert(vring_push(&vring, &value) == VRING_SUCCESS);
+        assert(vring_pop_n(&vring, out, INIT_CAPACITY * 2) == 8);
+        assert(!memcmp(out, values + 3, sizeof(int) * 7));
+        assert(out[7] == value);
+        assert(vring_size(&vring) == 0);
+
+        vring_free(&vring);
+        assert(vring.storage.value_bytes == NULL);
+    }
+    printf("%25s%15s\n", "vring spsc/mpmc", "success");
+
+    assert(vring_push_n(NULL, values, 1) == 0);
+    assert(vring_pop_n(NULL, out, 1) == 0);
+    /* the storage gets allocated, the sequences don't */
+    alloc_budget = 1;
+    valloc_set_default(&failing_allocator);
+    assert(vring_init(&vring, 64, sizeof(int), VRING_MPMC) == VRING_ERROR);
+    valloc_set_default(NULL);
+    assert(vring_init(&vring, (size_t)-1, sizeof(int), VRING_SPSC) == VRING_ERROR);
+    /* a whole line between the producer and the consumer group */
+    assert(offsetof(struct void_ring, head) - offsetof(struct void_ring, cached_head) > VRING_CACHE_LINE);
+    printf("%25s%15s\n", "vring errors", "success");
+}
+
+static void*
+cow_reader(void* snapshot) {
+    const struct vcow_version* version = (const struct vcow_version*)snapshot;
+    long sum = 0;
+    for (size_t i = 0; i < version->size; i++) {
+        sum += *(const int*)vcow_get(version, i);
+    }
+    vcow_release(version);
+    return (void*)sum;
+}
+
+static void
+void_cow_test() {
+    struct void_cow vcow;
+    const struct vcow_version* snapshot;
+    pthread_t reader;
+    void* sum;
+    int values[INIT_CAPACITY * 4];
+    int value = -1;
+
+    for (int i = 0; i < INIT_CAPACITY * 4; i++) {
+        values[i] = i;
+    }
+
+    assert(vcow_init(&vcow, INIT_CAPACITY, sizeof(int)) == VCOW_SUCCESS);
+    assert(vcow_add(&vcow, values, INIT_CAPACITY * 4 - 1) == VCOW_SUCCESS);
+    assert(vcow.head->size == INIT_CAPACITY * 4 - 1);
+    assert(vcow.head->chunks.size == 4);
+    assert(*(const int*)vcow_get(vcow.head, 10) == 10);
+    assert(vcow_get(vcow.head, INIT_CAPACITY * 4 - 1) == NULL);
+    printf("%25s%15s\n", "vcow_add", "success");
+
+    snapshot = vcow_snapshot(&vcow);
+    assert(snapshot == vcow.head);
+    assert(vcow_set(&vcow, 10, &value) == VCOW_SUCCESS);
+    assert(snapshot != vcow.head);
+    /* only the written chunk got copied */
+    assert(((struct vcow_chunk**)vcow.head->chunks.value_bytes)[0] == ((struct vcow_chunk**)snapshot->chunks.value_bytes)[0]);
+    assert(((struct vcow_chunk**)vcow.head->chunks.value_bytes)[10 / INIT_CAPACITY] != ((struct vcow_chunk**)snapshot->chunks.value_bytes)[10 / INIT_CAPACITY]);
+    assert(*(const int*)vcow_get(snapshot, 10) == 10);
+    assert(*(const int*)vcow_get(vcow.head, 10) == value);
+
+    /* appending copies the shared last chunk only */
+    assert(vcow_add(&vcow, &value, 1) == VCOW_SUCCESS);
+    assert(snapshot->size == INIT_CAPACITY * 4 - 1);
+    assert(*(const int*)vcow_get(vcow.head, INIT_CAPACITY * 4 - 1) == value);
+    printf("%25s%15s\n", "vcow_snapshot", "success");
+
+    assert(pthread_create(&reader, NULL, cow_reader, (void*)snapshot) == 0);
+    assert(vcow_set(&vcow, 0, &value) == VCOW_SUCCESS);
+    assert(pthread_join(reader, &sum) == 0);
+    assert((long)sum == (INIT_CAPACITY * 4 - 1) * (INIT_CAPACITY * 4 - 2) / 2);
+    /* the head is no longer shared and is written in place */
+    assert(vcow.head->refs == 1);
+    assert(vcow_write(&vcow, 1) == vcow_get(vcow.head, 1));
+    printf("%25s%15s\n", "vcow_release", "success");
+
+    vcow_free(&vcow);
+    assert(vcow.head == NULL);
+    printf("%25s%15s\n", "vcow_free", "success");
+
+    /* the version and its chunk list come from the default allocator, the chunk doesn't fit */
+    valloc_set_default(&failing_allocator);
+    alloc_budget = 0;
+    assert(vcow_init(&vcow, INIT_CAPACITY, sizeof(int)) == (VCOW_ERROR ^ VCOW_NO_MEMORY));
+    alloc_budget = 2;
+    assert(vcow_init(&vcow, INIT_CAPACITY, sizeof(int)) == VCOW_SUCCESS);
+    valloc_set_default(NULL);
+    assert(vcow.head->allocator == &failing_allocator);
+    assert(vcow_add(&vcow, values, 1) == (VCOW_ERROR ^ VCOW_NO_MEMORY));
+    vcow_free(&vcow);
+    printf("%25s%15s\n", "vcow allocator", "success");
+}
+
+#define CONC_PRODUCERS 4
+#define CONC_VALUES 2000
+
+struct conc_job {
+    struct void_array_concurrent* vconc;
+    int first;
+};
+
+static void*
+conc_producer(void* arg) {
+    struct conc_job* job = (struct conc_job*)arg;
+    int values[7];
+    for (int i = 0; i < CONC_VALUES; i += 7) {
+        int n = CONC_VALUES - i < 7 ? CONC_VALUES - i : 7;
+        for (int j = 0; j < n; j++) {
+            values[j] = job->first + i + j;
+        }
+        assert(varr_conc_add(job->vconc, values, n) == VARR_CONC_SUCCESS);
+    }
+    return NULL;
+}
+
+static void*
+conc_consumer(void* arg) {
+    struct void_array_concurrent* vconc = (struct void_array_concurrent*)arg;
+    size_t size = 0;
+    while (size < CONC_PRODUCERS * CONC_VALUES) {
+        size_t published = varr_conc_size(vconc);
+        int value;
+        assert(published >= size);
+        /* everything published is completely written */
+        if (published) {
+            assert(varr_conc_copy(vconc, published - 1, 1, &value) == VARR_CONC_SUCCESS);
+            assert(value > 0);
+        }
+        size = published;
+    }
+    return NULL;
+}
+
+/* appends until the storage can't grow anymore */
+static void*
+conc_failing_producer(void* arg) {
+    struct conc_job* job = (struct conc_job*)arg;
+    for (int i = 0; i < CONC_VALUES; i++) {
+        int value = job->first + i;
+        if (varr_conc_add(job->vconc, &value, 1) != VARR_CONC_SUCCESS) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+static void
+void_array_concurrent_test() {
+    struct void_array_concurrent vconc;
+    struct conc_job jobs[CONC_PRODUCERS];
+    pthread_t producers[CONC_PRODUCERS], consumer;
+    unsigned char seen[CONC_PRODUCERS * CONC_VALUES + 1] = { 0 };
+    size_t idx;
+    int* values;
+    int out[2];
+
+    assert(varr_conc_init(&vconc, 2, sizeof(int)) == VARR_CONC_SUCCESS);
+    assert(pthread_create(&consumer, NULL, conc_consumer, &vconc) == 0);
+    for (int t = 0; t < CONC_PRODUCERS; t++) {
+        jobs[t].vconc = &vconc;
+        jobs[t].first = t * CONC_VALUES + 1;
+        assert(pthread_create(producers + t, NULL, conc_producer, jobs + t) == 0);
+    }
+    for (int t = 0; t < CONC_PRODUCERS; t++) {
+        assert(pthread_join(producers[t], NULL) == 0);
+    }
+    assert(pthread_join(consumer, NULL) == 0);
+    assert(varr_conc_size(&vconc) == CONC_PRODUCERS * CONC_VALUES);
+    for (size_t i = 0; i < varr_conc_size(&vconc); i++) {
+        int value = *(const int*)varr_conc_at(&vconc, i);
+        assert(value > 0 && value <= CONC_PRODUCERS * CONC_VALUES && !seen[value]);
+        seen[value] = 1;
+    }
+    printf("%25s%15s\n", "varr_conc_add", "success");
+
+    /* values never move, pointers to them stay valid while the array grows */
+    values = (int*)varr_conc_at(&vconc, 0);
+    assert(varr_conc_begin(&vconc, 2, &idx) == VARR_CONC_SUCCESS);
+    assert(idx == CONC_PRODUCERS * CONC_VALUES);
+    *(int*)varr_conc_at(&vconc, idx) = -1;
+    *(int*)varr_conc_at(&vconc, idx + 1) = -2;
+    varr_conc_commit(&vconc, idx, 2);
+    assert(varr_conc_copy(&vconc, idx, 2, out) == VARR_CONC_SUCCESS && out[0] == -1 && out[1] == -2);
+    assert(varr_conc_copy(&vconc, idx + 1, 2, out) == (VARR_CONC_ERROR ^ VARR_CONC_INDEX_OUT_OF_RANGE));
+    assert(varr_conc_at(&vconc, 0) == values);
+    printf("%25s%15s\n", "varr_conc_begin/commit", "success");
+
+    varr_conc_free(&vconc);
+    assert(vconc.chunks.value_bytes == NULL);
+    printf("%25s%15s\n", "varr_conc_free", "success");
+
+    /* a failed chunk allocation takes the last reservation back */
+    valloc_set_default(&failing_allocator);
+    alloc_budget = 1;
+    assert(varr_conc_init(&vconc, 2, sizeof(int)) == VARR_CONC_ERROR);
+    assert(varr_conc_init(&vconc, 2, 0) == VARR_CONC_ERROR);
+    alloc_budget = 2;
+    assert(varr_conc_init(&vconc, 2, sizeof(int)) == VARR_CONC_SUCCESS);
+    valloc_set_default(NULL);
+    alloc_budget = 0;
+    assert(varr_conc_add(&vconc, out, 2) == VARR_CONC_SUCCESS);
+    assert(varr_conc_add(&vconc, out, 1) == VARR_CONC_ERROR);
+    assert(vconc.reserved == 2 && !vconc.failed);
+    assert(varr_conc_begin(&vconc, (size_t)-1 / 2, &idx) == VARR_CONC_ERROR);
+    assert(vconc.reserved == 2 && !vconc.failed);
+    alloc_budget = 1;
+    assert(varr_conc_add(&vconc, out, 1) == VARR_CONC_SUCCESS);
+    assert(varr_conc_size(&vconc) == 3);
+    varr_conc_free(&vconc);
+
+    /* producers running out of memory neither hang nor publish unwritten values */
+    valloc_set_default(&failing_allocator);
+    alloc_budget = 2;
+    assert(varr_conc_init(&vconc, 2, sizeof(int)) == VARR_CONC_SUCCESS);
+    valloc_set_default(NULL);
+    /* chunks of 4, 8 and 16 values */
+    alloc_budget = 3;
+    memset(seen, 0, sizeof(seen));
+    for (int t = 0; t < CONC_PRODUCERS; t++) {
+        jobs[t].vconc = &vconc;
+        jobs[t].first = t * CONC_VALUES + 1;
+        assert(pthread_create(producers + t, NULL, conc_failing_producer, jobs + t) == 0);
+    }
+    for (int t = 0; t < CONC_PRODUCERS; t++) {
+        assert(pthread_join(producers[t], NULL) == 0);
+    }
+    assert(varr_conc_size(&vconc) == 2 + 4 + 8 + 16);
+    for (size_t i = 0; i < varr_conc_size(&vconc); i++) {
+        int value = *(const int*)varr_conc_at(&vconc, i);
+        assert(value > 0 && value <= CONC_PRODUCERS * CONC_VALUES && !seen[value]);
+        seen[value] = 1;
+    }
+    varr_conc_free(&vconc);
+    printf("%25s%15s\n", "varr_conc_add - no memory", "success");
+}
+
+static void
+void_array_mmap_test() {
+    struct void_array varray;
+    char path[] = "/tmp/void_array_mmap_XXXXXX";
+    double values[INIT_CAPACITY * 3];
+    int fd = mkstemp(path);
+
+    assert(fd >= 0);
+    close(fd);
+    for (int i = 0; i < INIT_CAPACITY * 3; i++) {
+        values[i] = i * 1.5;
+    }
+
+    assert(varr_mmap_open(&varray, path, INIT_CAPACITY, sizeof(double)) == VARR_SUCCESS);
+    assert(varray.size == 0);
+    assert(varray.capacity == INIT_CAPACITY);
+    assert(varr_add(&varray, values, INIT_CAPACITY * 3) == VARR_SUCCESS);
+    assert(varray.capacity >= INIT_CAPACITY * 3);
+    assert(*(double*)varr_get(&varray, INIT_CAPACITY * 2) == values[INIT_CAPACITY * 2]);
+    assert(varr_mmap_sync(&varray) == VARR_SUCCESS);
+    assert(varr_mmap_close(&varray) == VARR_SUCCESS);
+    assert(varray.value_bytes == NULL);
+    printf("%25s%15s\n", "varr_mmap_open - create", "success");
+
+    assert(varr_mmap_open(&varray, path, 1, sizeof(double)) == VARR_SUCCESS);
+    assert(varray.size == INIT_CAPACITY * 3);
+    assert(!memcmp(varray.value_bytes, values, sizeof(values)));
+    assert(varr_remove(&varray, 0, INIT_CAPACITY) == VARR_SUCCESS);
+    assert(varr_mmap_close(&varray) == VARR_SUCCESS);
+    assert(varr_mmap_open(&varray, path, 1, sizeof(double)) == VARR_SUCCESS);
+    assert(varray.size == INIT_CAPACITY * 2);
+    assert(!memcmp(varray.value_bytes, values + INIT_CAPACITY, sizeof(double) * INIT_CAPACITY * 2));
+    assert(varr_mmap_close(&varray) == VARR_SUCCESS);
+    printf("%25s%15s\n", "varr_mmap_open - reopen", "success");
+
+    assert(varr_mmap_open(&varray, path, 1, 0) == VARR_ERROR);
+
+    assert(varr_init(&varray, 1, sizeof(double), NULL) == VARR_SUCCESS);
+    assert(varr_mmap_sync(&varray) == (VARR_ERROR ^ VARR_FILE_ERROR));
+    varr_free(&varray);
+    unlink(path);
+}
+
+static void
+add_long(void* acc, const void* value, void* arg) {
+    (void)arg;
+    *(long*)acc += *(const long*)value;
+}
+
+static void
+square_long(const void* in, void* out, void* arg) {
+    (void)arg;
+    *(long*)out = *(const long*)in * *(const long*)in;
+}
+
+static void
+increment_long(void* value, void* arg) {
+    *(long*)value += *(long*)arg;
+}
+
+struct par_caller {
+    struct void_thread_pool* pool;
+    const struct void_array* varray;
+    long expected;
+};
+
+static void*
+par_reducer(void* caller_ptr) {
+    const struct par_caller* caller = (const struct par_caller*)caller_ptr;
+    const long zero = 0;
+    long sum;
+
+    for (int round = 0; round < 50; round++) {
+        assert(vpar_reduce(caller->pool, caller->varray, &sum, &zero, add_long, NULL) == VPAR_SUCCESS);
+        assert(sum == caller->expected);
+    }
+    return NULL;
+}
+
+static void
+void_parallel_test() {
+    struct void_thread_pool pool;
+    struct void_array varray, mapped;
+    const long n = 100000, zero = 0, one = 1;
+    long sum;
+
+    assert(vtpool_init(&pool, 4) == VPAR_SUCCESS);
+    assert(pool.thread_count == 4);
+    assert(varr_init(&varray, n, sizeof(long), NULL) == VARR_SUCCESS);
+    assert(varr_init(&mapped, 1, sizeof(long), NULL) == VARR_SUCCESS);
+    for (long i = 0; i < n; i++) {
+        assert(varr_add(&varray, &i, 1) == VARR_SUCCESS);
+    }
+
+    assert(vpar_for_each(&pool, &varray, increment_long, (void*)&one) == VPAR_SUCCESS);
+    assert(*(long*)varr_get(&varray, 0) == 1 && *(long*)varr_get(&varray, n - 1) == n);
+    printf("%25s%15s\n", "vpar_for_each", "success");
+
+    assert(vpar_reduce(&pool, &varray, &sum, &zero, add_long, NULL) == VPAR_SUCCESS);
+    assert(sum == n * (n + 1) / 2);
+    assert(vpar_reduce(NULL, &varray, &sum, &zero, add_long, NULL) == VPAR_SUCCESS);
+    assert(sum == n * (n + 1) / 2);
+    printf("%25s%15s\n", "vpar_reduce", "success");
+
+    /* callers sharing the pool take turns on its job slot */
+    {
+        struct par_caller caller = { &pool, &varray, n * (n + 1) / 2 };
+        pthread_t other;
+        assert(pthread_create(&other, NULL, par_reducer, &caller) == 0);
+        par_reducer(&caller);
+        assert(pthread_join(other, NULL) == 0);
+    }
+    printf("%25s%15s\n", "vpar_reduce - callers", "success");
+
+    assert(vpar_map(&pool, &varray, &mapped, square_long, NULL) == VPAR_SUCCESS);
+    assert(mapped.size == varray.size);
+    assert(*(long*)varr_get(&mapped, 999) == 1000 * 1000);
+    printf("%25s%15s\n", "vpar_map", "success");
+
+    assert(vpar_scan(&pool, &varray, &mapped, &zero, add_long, NULL) == VPAR_SUCCESS);
+    assert(*(long*)varr_get(&mapped, 0) == 1);
+    assert(*(long*)varr_get(&mapped, 9999) == 10000L * 10001 / 2);
+    assert(*(long*)varr_get(&mapped, n - 1) == n * (n + 1) / 2);
+    assert(vpar_scan(&pool, &varray, &varray, &zero, add_long, NULL) == VPAR_SUCCESS);
+    assert(!memcmp(varray.value_bytes, mapped.value_bytes, sizeof(long) * n));
+    printf("%25s%15s\n", "vpar_scan", "success");
+
+    assert(vpar_chunk_size(NULL, n, 0) >= 1);
+    assert(vpar_chunk_size(&pool, 0, 0) == 1);
+    printf("%25s%15s\n", "vpar_chunk_size", "success");
+
+    /* the partial results come from the array's allocator */
+    {
+        struct void_array small;
+        alloc_budget = 1;
+        assert(varr_init_alloc(&small, 4, sizeof(long), NULL, &failing_allocator) == VARR_SUCCESS);
+        assert(vpar_reduce(&pool, &small, &sum, &zero, add_long, NULL) == VPAR_ERROR);
+        assert(vpar_scan(&pool, &small, &small, &zero, add_long, NULL) == VPAR_ERROR);
+        varr_free(&small);
+    }
+    printf("%25s%15s\n", "vpar_reduce - no memory", "success");
+
+    varr_free(&mapped);
+    varr_free(&varray);
+    vtpool_free(&pool);
+    assert(pool.threads == NULL);
+    printf("%25s%15s\n", "vtpool_free", "success");
+}
+
+static void
+void_slotmap_test() {
+    struct void_slotmap vslot;
+    uint64_t handles[INIT_CAPACITY * 2];
+    uint64_t reused;
+
+    assert(vslot_init(&vslot, INIT_CAPACITY, sizeof(int), NULL) == VSLOT_SUCCESS);
+    for (int i = 0; i < INIT_CAPACITY * 2; i++) {
+        handles[i] = vslot_insert(&vslot, &i);
+        assert(handles[i] != VSLOT_NULL);
+    }
+    assert(vslot.values.size == INIT_CAPACITY * 2);
+    assert(*(int*)vslot_get(&vslot, handles[3]) == 3);
+    printf("%25s%15s\n", "vslot_insert", "success");
+
+    assert(vslot_erase(&vslot, handles[0]) == VSLOT_SUCCESS);
+    assert(vslot_get(&vslot, handles[0]) == NULL);
+    assert(vslot_erase(&vslot, handles[0]) == (VSLOT_ERROR ^ VSLOT_STALE_HANDLE));
+    assert(vslot.values.size == INIT_CAPACITY * 2 - 1);
+    /* the last value moved into the gap and keeps its handle */
+    assert(*(int*)vslot.values.value_bytes == INIT_CAPACITY * 2 - 1);
+    assert(vslot_handle_at(&vslot, 0) == handles[INIT_CAPACITY * 2 - 1]);
+    assert(*(int*)vslot_get(&vslot, handles[INIT_CAPACITY * 2 - 1]) == INIT_CAPACITY * 2 - 1);
+    printf("%25s%15s\n", "vslot_erase", "success");
+
+    int value = 42;
+    reused = vslot_insert(&vslot, &value);
+    assert((uint32_t)reused == (uint32_t)handles[0]);
+    assert(reused != handles[0]);
+    assert(vslot_get(&vslot, handles[0]) == NULL);
+    assert(*(int*)vslot_get(&vslot, reused) == value);
+    printf("%25s%15s\n", "vslot_get - generations", "success");
+
+    assert(vslot_clear(&vslot) == VSLOT_SUCCESS);
+    assert(vslot.values.size == 0);
+    assert(vslot_get(&vslot, reused) == NULL);
+    vslot_free(&vslot);
+    assert(vslot.values.value_bytes == NULL);
+    printf("%25s%15s\n", "vslot_free", "success");
+
+    /* a copied Slot Map reads its inline values from the copy */
+    {
+        struct void_slotmap copy;
+        assert(vslot_init(&vslot, 2, sizeof(int), NULL) == VSLOT_SUCCESS);
+        reused = vslot_insert(&vslot, &value);
+        copy = vslot;
+        memset(&vslot, 0, sizeof(vslot));
+        assert(*(int*)vslot_get(&copy, reused) == value);
+        assert(vslot_erase(&copy, reused) == VSLOT_SUCCESS);
+        vslot_free(&copy);
+    }
+    printf("%25s%15s\n", "vslot copy", "success");
+
+    /* a failed insert hands out no handle and keeps its slot for the next one */
+    valloc_set_default(&failing_allocator);
+    alloc_budget = 0;
+    assert(vslot_init(&vslot, INIT_CAPACITY * 20, sizeof(int), NULL) == VSLOT_ERROR);
+    alloc_budget = 1;
+    assert(vslot_insert(&vslot, &value) == VSLOT_NULL);
+    assert(vslot.slots.size == 1 && vslot.values.size == 0);
+    alloc_budget = 1;
+    assert(vslot_insert(&vslot, &value) == VSLOT_NULL);
+    assert(vslot.slots.size == 1 && vslot.values.size == 0 && vslot.value_slots.size == 0);
+    alloc_budget = 1;
+    reused = vslot_insert(&vslot, &value);
+    valloc_set_default(NULL);
+    assert(reused != VSLOT_NULL && vslot.slots.size == 1);
+    assert(*(int*)vslot_get(&vslot, reused) == value && vslot_handle_at(&vslot, 0) == reused);
+    vslot_free(&vslot);
+    printf("%25s%15s\n", "vslot - no memory", "success");
+}
+
+struct heap_task {
+    double payload;
+    int priority;
+};
+
+static int
+cmp_heap_task(const void* a, const void* b) {
+    return ((const struct heap_task*)a)->priority - ((const struct heap_task*)b)->priority;
+}
+
+/* values of small heaps are stored inside the structure, which is copied on return */
+static struct void_heap
+small_heap(const int* values, size_t n) {
+    struct void_heap vheap;
+    assert(vheap_init(&vheap, 4, sizeof(int), 2, NULL) == VHEAP_SUCCESS);
+    assert(vheap_set_key(&vheap, 0, sizeof(int), 1) == VHEAP_SUCCESS);
+    for (size_t i = 0; i < n; i++) {
+        assert(vheap_push(&vheap, values + i) != VHEAP_NULL);
+    }
+    return vheap;
+}
+
+static void
+void_heap_test() {
+    struct void_heap vheap;
+    struct heap_task tasks[INIT_CAPACITY * 4];
+    struct heap_task task;
+    size_t first, handle;
+
+    for (int i = 0; i < INIT_CAPACITY * 4; i++) {
+        tasks[i].payload = i;
+        tasks[i].priority = (i * 7919) % 97 - 40;
+    }
+
+    for (size_t arity = 2; arity <= 8; arity <<= 1) {
+        assert(vheap_init(&vheap, INIT_CAPACITY, sizeof(struct heap_task), arity, cmp_heap_task) == VHEAP_SUCCESS);
+        if (arity == 4) {
+            assert(vheap_set_key(&vheap, offsetof(struct heap_task, priority), sizeof(int), 1) == VHEAP_SUCCESS);
+        }
+        for (int i = 0; i < INIT_CAPACITY * 2; i++) {
+            assert(vheap_push(&vheap, tasks + i) == (size_t)i);
+        }
+        assert(vheap_heapify(&vheap, tasks + INIT_CAPACITY * 2, INIT_CAPACITY * 2, &first) == VHEAP_SUCCESS);
+        assert(first == INIT_CAPACITY * 2);
+        assert(((const struct heap_task*)vheap_get(&vheap, first + 3))->payload == tasks[first + 3].payload);
+
+        /* decrease-key moves a value on top */
+        task = tasks[5];
+        task.priority = -100;
+        assert(vheap_update(&vheap, 5, &task) == VHEAP_SUCCESS);
+        assert(((const struct heap_task*)vheap_top(&vheap))->payload == 5);
+        assert(vheap_remove(&vheap, 5) == VHEAP_SUCCESS);
+        assert(vheap_get(&vheap, 5) == NULL);
+        assert(vheap_update(&vheap, 5, &task) == (VHEAP_ERROR ^ VHEAP_STALE_HANDLE));
+
+        int last = -1000;
+        for (int i = 0; i < INIT_CAPACITY * 4 - 1; i++) {
+            assert(vheap_pop(&vheap, &task) == VHEAP_SUCCESS);
+            assert(task.priority >= last);
+            last = task.priority;
+        }
+        assert(vheap_pop(&vheap, &task) == (VHEAP_ERROR ^ VHEAP_EMPTY));
+        /* reuses a slot, but none of the old handles */
+        handle = vheap_push(&vheap, tasks);
+        assert(vheap_get(&vheap, handle) != NULL);
+        for (size_t i = 0; i < INIT_CAPACITY * 4; i++) {
+            assert(vheap_get(&vheap, i) == NULL);
+        }
+        assert(vheap.positions.size == INIT_CAPACITY * 4);
+        assert(vheap_clear(&vheap) == VHEAP_SUCCESS);
+        assert(vheap_top(&vheap) == NULL);
+        assert(vheap_get(&vheap, handle) == NULL);
+        assert(vheap_remove(&vheap, handle) == (VHEAP_ERROR ^ VHEAP_STALE_HANDLE));
+        vheap_free(&vheap);
+        assert(vheap.hole == NULL);
+    }
+    printf("%25s%15s\n", "vheap 2/4/8-ary", "success");
+
+    {
+        const int values[3] = { 3, -1, 2 };
+        int value;
+        vheap = small_heap(values, 3);
+        assert(*(const int*)vheap_top(&vheap) == -1);
+        assert(vheap_pop(&vheap, &value) == VHEAP_SUCCESS && value == -1);
+        assert(*(const int*)vheap_get(&vheap, 0) == 3);
+        vheap_free(&vheap);
+    }
+    printf("%25s%15s\n", "vheap returned by value", "success");
+
+    /* failed appends leave the heap as it was */
+    valloc_set_default(&failing_allocator);
+    alloc_budget = 0;
+    assert(vheap_init(&vheap, INIT_CAPACITY * 2, sizeof(struct heap_task), 2, cmp_heap_task) == VHEAP_ERROR);
+    alloc_budget = 5;
+    assert(vheap_init(&vheap, INIT_CAPACITY * 2, sizeof(struct heap_task), 2, cmp_heap_task) == VHEAP_SUCCESS);
+    assert(vheap_heapify(&vheap, tasks, INIT_CAPACITY * 2, NULL) == VHEAP_SUCCESS);
+    /* generations and positions grow, values don't */
+    alloc_budget = 2;
+    assert(vheap_push(&vheap, tasks) == VHEAP_NULL);
+    assert(vheap.values.size == INIT_CAPACITY * 2 && vheap.positions.size == INIT_CAPACITY * 2);
+    alloc_budget = 4;
+    assert(vheap_heapify(&vheap, tasks, INIT_CAPACITY * 2 + 1, NULL) == VHEAP_ERROR);
+    assert(vheap.values.size == INIT_CAPACITY * 2 && vheap.value_handles.size == INIT_CAPACITY * 2);
+    assert(vheap.positions.size == INIT_CAPACITY * 2 && vheap.free_handle == VHEAP_NULL);
+    valloc_set_default(NULL);
+    /* the next push gets the slot the failed one didn't */
+    assert(vheap_push(&vheap, tasks + 1) == INIT_CAPACITY * 2);
+    assert(vheap.values.size == INIT_CAPACITY * 2 + 1 && vheap_pop(&vheap, &task) == VHEAP_SUCCESS);
+    assert(task.priority <= ((const struct heap_task*)vheap_top(&vheap))->priority);
+    vheap_free(&vheap);
+    printf("%25s%15s\n", "vheap - no memory", "success");
+}
+
+static void
+void_vector_test() {
+    vvec vec;
+    int values[INIT_CAPACITY * 2];
+    int* slot;
+
+    for (int i = 0; i < INIT_CAPACITY * 2; i++) {
+        values[i] = i;
+    }
+
+    vvec_init(&vec, sizeof(int));
+    assert(vvec_empty(&vec));
+    vvec_push_back(&vec, values, INIT_CAPACITY * 2);
+    assert(vec.count == INIT_CAPACITY * 2 && vec.capacity == 16);
+    assert(*(int*)vvec_back(&vec) == INIT_CAPACITY * 2 - 1);
+    slot = vvec_emplace_back(&vec);
+    *slot = 42;
+    assert(*(int*)vvec_at(&vec, INIT_CAPACITY * 2) == 42);
+    printf("%25s%15s\n", "vvec_emplace_back", "success");
+
+    vvec_pop_back(&vec);
+    assert(vec.count == INIT_CAPACITY * 2);
+    assert(*(int*)vvec_insert(&vec, 1, values + 7, 2) == 7);
+    assert(*(int*)vvec_at(&vec, 3) == 1 && *(int*)vvec_back(&vec) == INIT_CAPACITY * 2 - 1);
+    assert(*(int*)vvec_erase_range_idx(&vec, 1, 3) == 1);
+    assert(vec.count == INIT_CAPACITY * 2);
+    assert(!memcmp(vec.data, values, sizeof(values)));
+    assert(*(int*)vvec_erase_idx(&vec, 0) == 1);
+    assert(*(int*)vvec_front(&vec) == 1);
+    printf("%25s%15s\n", "vvec_erase_range", "success");
+
+    assert(*(int*)vvec_swap_remove(&vec, 0) == INIT_CAPACITY * 2 - 1);
+    assert(vec.count == INIT_CAPACITY * 2 - 2);
+    assert(*(int*)vvec_back(&vec) == INIT_CAPACITY * 2 - 2);
+    printf("%25s%15s\n", "vvec_swap_remove", "success");
+
+    vvec_clear(&vec);
+    assert(vvec_empty(&vec));
+    vvec_free(&vec);
+    assert(vec.data == NULL);
+    printf("%25s%15s\n", "vvec_free", "success");
+}
+
+static void
+telemetry_hook(int family, int event, size_t old_size, size_t new_size, void* arg) {
+    (void)event;
+    (void)old_size;
+    (void)new_size;
+    if (family == VTELEM_ARRAY) {
+        (*(size_t*)arg)++;
+    }
+}
+
+static void
+void_telemetry_test() {
+    struct void_array varray;
+    struct vtelem_counters counters;
+    size_t events = 0;
+    int values[INIT_CAPACITY * 2];
+    int value = 100;
+
+    for (int i = 0; i < INIT_CAPACITY * 2; i++) {
+        values[i] = i;
+    }
+
+    vtelem_reset();
+    vtelem_set_hook(telemetry_hook, &events);
+    assert(varr_init_alloc(&varray, 2, sizeof(int), NULL, &valloc_stdlib) == VARR_SUCCESS);
+    assert(varr_add(&varray, values, INIT_CAPACITY * 2) == VARR_SUCCESS);
+    assert(varr_insert(&varray, 2, &value, 1) == VARR_SUCCESS);
+    /* every value from the index on moved to the right */
+    assert(*(int*)varr_get(&varray, 2) == value);
+    assert(*(int*)varr_get(&varray, 3) == 2);
+    assert(*(int*)varr_get(&varray, INIT_CAPACITY * 2) == INIT_CAPACITY * 2 - 1);
+    assert(varr_remove(&varray, 0, 1) == VARR_SUCCESS);
+    assert(*(int*)varr_get(&varray, 1) == value);
+    varr_free(&varray);
+    vtelem_set_hook(NULL, NULL);
+    vtelem_get(VTELEM_ARRAY, &counters);
+#ifdef VOID_TELEMETRY
+    assert(counters.allocations == 1);
+    assert(counters.reallocations == 1);
+    assert(counters.frees == 1);
+    assert(counters.bytes_allocated == sizeof(int) * 16);
+    assert(counters.bytes_freed == counters.bytes_allocated);
+    assert(counters.bytes_moved == sizeof(int) * (INIT_CAPACITY * 2 - 2) + sizeof(int) * INIT_CAPACITY * 2);
+    assert(events == 3);
+#else
+    /* compiled out */
+    assert(counters.allocations == 0 && counters.bytes_moved == 0);
+    assert(events == 0);
+#endif
+    printf("%25s%15s\n", "vtelem_get", "success");
+
+    /* a failed allocation is neither an allocation nor a later free */
+    vtelem_reset();
+    alloc_budget = 0;
+    assert(varr_init_alloc(&varray, INIT_CAPACITY, sizeof(int), NULL, &failing_allocator) == VARR_ERROR);
+    varr_free(&varray);
+    vtelem_get(VTELEM_ARRAY, &counters);
+    assert(counters.allocations == 0 && counters.frees == 0);
+    assert(counters.bytes_allocated == 0 && counters.bytes_freed == 0);
+    printf("%25s%15s\n", "vtelem_get - no memory", "success");
+
+#if VARR_INLINE_BYTES >= 64
+    /* spilling the small buffer is the first allocation of the array */
+    vtelem_reset();
+    assert(varr_init(&varray, 2, sizeof(int), NULL) == VARR_SUCCESS);
+    assert(varr_add(&varray, values, INIT_CAPACITY * 2) == VARR_SUCCESS);
+    vtelem_get(VTELEM_ARRAY, &counters);
+    assert(counters.allocations == 0);
+    assert(varr_add(&varray, values, INIT_CAPACITY * 2) == VARR_SUCCESS);
+    vtelem_get(VTELEM_ARRAY, &counters);
+#ifdef VOID_TELEMETRY
+    assert(counters.allocations == 1 && counters.reallocations == 0);
+    assert(counters.bytes_allocated == sizeof(int) * 32);
+#endif
+    varr_free(&varray);
+    vtelem_get(VTELEM_ARRAY, &counters);
+    assert(counters.bytes_freed == counters.bytes_allocated);
+    printf("%25s%15s\n", "vtelem_get - spill", "success");
+#endif
+}
+
+static int
+cmp_flatmap_str(const void* a, const void* b) {
+    return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+
+static void
+void_flatmap_test() {
+    struct void_flatmap vfmap;
+    uint32_t keys[INIT_CAPACITY * 20];
+    int values[INIT_CAPACITY * 20];
+    uint32_t key, high;
+    size_t first;
+    int value;
+
+    /* odd keys backwards, the last pair of key 7 wins */
+    for (int i = 0; i < INIT_CAPACITY * 20; i++) {
+        keys[i] = (uint32_t)(INIT_CAPACITY * 40 - 2 * i - 1);
+        values[i] = i;
+    }
+    keys[INIT_CAPACITY * 20 - 1] = 7;
+    assert(vfmap_init(&vfmap, 3, sizeof(int), NULL) == VFMAP_ERROR);
+    assert(vfmap_init(&vfmap, sizeof(uint32_t), sizeof(int), NULL) == VFMAP_SUCCESS);
+    assert(vfmap_build(&vfmap, keys, values, INIT_CAPACITY * 20) == VFMAP_SUCCESS);
+    assert(vfmap.keys.size == INIT_CAPACITY * 20 - 1);
+    for (int i = 0; i < INIT_CAPACITY * 20 - 2; i++) {
+        assert(*(uint32_t*)varr_get(&vfmap.keys, i) == (uint32_t)(2 * i + 3));
+    }
+    key = 7;
+    assert(*(int*)vfmap_get(&vfmap, &key) == INIT_CAPACITY * 20 - 1);
+    key = 9;
+    assert(*(int*)vfmap_get(&vfmap, &key) == INIT_CAPACITY * 20 - 5);
+    key = 8;
+    assert(vfmap_get(&vfmap, &key) == NULL);
+    assert(vfmap_lower_bound(&vfmap, &key) == 3);
+    key = 1;
+    assert(vfmap_get(&vfmap, &key) == NULL);
+    assert(vfmap_lower_bound(&vfmap, &key) == 0);
+    key = INIT_CAPACITY * 40;
+    assert(vfmap_lower_bound(&vfmap, &key) == vfmap.keys.size);
+    printf("%25s%15s\n", "vfmap_get", "success");
+
+    key = 4;
+    high = 11;
+    assert(vfmap_range(&vfmap, &key, &high, &first) == 4);
+    assert(first == 1 && *(uint32_t*)varr_get(&vfmap.keys, first) == 5);
+    high = 3;
+    assert(vfmap_range(&vfmap, &key, &high, &first) == 0);
+    printf("%25s%15s\n", "vfmap_range", "success");
+
+    key = 8;
+    value = -1;
+    assert(vfmap_insert(&vfmap, &key, &value) == VFMAP_SUCCESS);
+    assert(vfmap.dirty);
+    assert(*(int*)vfmap_get(&vfmap, &key) == -1);
+    key = 9;
+    assert(vfmap_erase(&vfmap, &key) == VFMAP_SUCCESS);
+    assert(vfmap_erase(&vfmap, &key) == (VFMAP_ERROR ^ VFMAP_KEY_404));
+    assert(vfmap_get(&vfmap, &key) == NULL);
+    assert(vfmap_rebuild(&vfmap) == VFMAP_SUCCESS);
+    assert(!vfmap.dirty);
+    assert(vfmap_get(&vfmap, &key) == NULL);
+    key = 8;
+    assert(*(int*)vfmap_get(&vfmap, &key) == -1);
+    key = 4;
+    high = 11;
+    assert(vfmap_range(&vfmap, &key, &high, &first) == 4);
+    for (uint32_t k = 0; k <= INIT_CAPACITY * 40; k++) {
+        size_t idx = vfmap_lower_bound(&vfmap, &k);
+        assert(idx == vfmap.keys.size || *(uint32_t*)varr_get(&vfmap.keys, idx) >= k);
+        assert(idx == 0 || *(uint32_t*)varr_get(&vfmap.keys, idx - 1) < k);
+    }
+    printf("%25s%15s\n", "vfmap_insert/erase", "success");
+    vfmap_free(&vfmap);
+
+    /* keys and values stay the same size and searchable when memory runs out */
+    valloc_set_default(&failing_allocator);
+    alloc_budget = 0;
+    assert(vfmap_init(&vfmap, sizeof(uint32_t), sizeof(int), NULL) == VFMAP_SUCCESS);
+    valloc_set_default(NULL);
+    alloc_budget = 2;
+    assert(vfmap_build(&vfmap, keys, values, INIT_CAPACITY * 20) == VFMAP_ERROR);
+    assert(vfmap.dirty && vfmap.keys.size > 0 && vfmap.keys.size == vfmap.values.size);
+    key = 3;
+    assert(*(int*)vfmap_get(&vfmap, &key) == INIT_CAPACITY * 20 - 2);
+    key = 0;
+    assert(vfmap_insert(&vfmap, &key, &value) == VFMAP_ERROR);
+    alloc_budget = 1;
+    assert(vfmap_insert(&vfmap, &key, &value) == VFMAP_ERROR);
+    assert(vfmap.keys.size == vfmap.values.size && vfmap_get(&vfmap, &key) == NULL);
+    alloc_budget = 0;
+    assert(vfmap_rebuild(&vfmap) == VFMAP_ERROR);
+    assert(vfmap.dirty && vfmap.eyt_keys.size == 0);
+    key = 3;
+    assert(*(int*)vfmap_get(&vfmap, &key) == INIT_CAPACITY * 20 - 2);
+    alloc_budget = 3;
+    assert(vfmap_rebuild(&vfmap) == VFMAP_SUCCESS);
+    assert(*(int*)vfmap_get(&vfmap, &key) == INIT_CAPACITY * 20 - 2);
+    vfmap_free(&vfmap);
+    printf("%25s%15s\n", "vfmap - no memory", "success");
+
+    const char* names[] = {"pear", "apple", "fig", "kiwi"};
+    const char* name = "fig";
+    const char* last = "kiwi";
+    int ids[] = {0, 1, 2, 3};
+    assert(vfmap_init(&vfmap, sizeof(char*), sizeof(int), cmp_flatmap_str) == VFMAP_SUCCESS);
+    assert(vfmap_build(&vfmap, names, ids, 4) == VFMAP_SUCCESS);
+    assert(*(int*)vfmap_get(&vfmap, &name) == 2);
+    assert(vfmap_range(&vfmap, &name, &last, &first) == 2 && first == 1);
+    vfmap_free(&vfmap);
+    assert(vfmap.keys.value_bytes == NULL);
+    printf("%25s%15s\n", "vfmap_free", "success");
+}
+
+struct table_record {
+    int id;
+    double price;
+    char tag;
+};
+
+static void
+void_table_test() {
+    struct void_table vtab;
+    struct table_record records[INIT_CAPACITY * 2];
+    size_t sizes[] = {sizeof(int), sizeof(double), sizeof(char)};
+    size_t offsets[] = {offsetof(struct table_record, id), offsetof(struct table_record, price), offsetof(struct table_record, tag)};
+    int ids[] = {-1, -2};
+    double prices[] = {0.5, 0.25};
+    char tags[] = {'x', 'y'};
+    const void* fields[] = {ids, prices, tags};
+    int id;
+    double price;
+    char tag;
+    void* out[] = {&id, &price, &tag};
+
+    for (int i = 0; i < INIT_CAPACITY * 2; i++) {
+        records[i].id = i;
+        records[i].price = i * 1.5;
+        records[i].tag = (char)('a' + i);
+    }
+    assert(vtab_init(&vtab, INIT_CAPACITY, 3, sizes) == VTAB_SUCCESS);
+    assert(vtab.columns.size == 3 && vtab.rows == 0);
+    assert(vtab_add_records(&vtab, records, INIT_CAPACITY * 2, sizeof(struct table_record), offsets) == VTAB_SUCCESS);
+    assert(vtab.rows == INIT_CAPACITY * 2);
+    for (int i = 0; i < INIT_CAPACITY * 2; i++) {
+        assert(((int*)vtab_column_data(&vtab, 0))[i] == i);
+        assert(((double*)vtab_column_data(&vtab, 1))[i] == i * 1.5);
+        assert(*(const char*)vtab_get(&vtab, i, 2) == 'a' + i);
+    }
+    assert(vtab_column(&vtab, 1)->size == INIT_CAPACITY * 2);
+    assert(vtab_column(&vtab, 3) == NULL && vtab_get(&vtab, INIT_CAPACITY * 2, 0) == NULL);
+    printf("%25s%15s\n", "vtab_add_records", "success");
+
+    assert(vtab_insert(&vtab, 1, fields, 2) == VTAB_SUCCESS);
+    assert(vtab_add(&vtab, fields, 1) == VTAB_SUCCESS);
+    assert(vtab.rows == INIT_CAPACITY * 2 + 3);
+    assert(vtab_get_row(&vtab, 2, out) == VTAB_SUCCESS);
+    assert(id == -2 && price == 0.25 && tag == 'y');
+    assert(vtab_get_row(&vtab, 3, out) == VTAB_SUCCESS);
+    assert(id == 1 && price == 1.5 && tag == 'b');
+    assert(vtab_get_row(&vtab, vtab.rows - 1, out) == VTAB_SUCCESS);
+    assert(id == -1 && tag == 'x');
+    assert(vtab_insert(&vtab, vtab.rows + 1, fields, 1) == (VTAB_ERROR ^ VTAB_INDEX_OUT_OF_RANGE));
+    printf("%25s%15s\n", "vtab_insert", "success");
+
+    assert(vtab_remove(&vtab, 1, 2) == VTAB_SUCCESS);
+    assert(vtab.rows == INIT_CAPACITY * 2 + 1);
+    assert(*(const int*)vtab_get(&vtab, 1, 0) == 1);
+    assert(*(const char*)vtab_get(&vtab, 1, 2) == 'b');
+    assert(vtab_remove(&vtab, vtab.rows, 1) == (VTAB_ERROR ^ VTAB_INDEX_OUT_OF_RANGE));
+    price = 9.0;
+    assert(vtab_set(&vtab, 0, 1, &price) == VTAB_SUCCESS);
+    assert(*(const double*)vtab_get(&vtab, 0, 1) == 9.0);
+    assert(vtab_set(&vtab, 0, 3, &price) == (VTAB_ERROR ^ VTAB_COLUMN_404));
+    printf("%25s%15s\n", "vtab_remove", "success");
+
+    assert(vtab_clear(&vtab) == VTAB_SUCCESS);
+    assert(vtab.rows == 0 && vtab_column(&vtab, 0)->size == 0);
+    vtab_free(&vtab);
+    assert(vtab.columns.value_bytes == NULL && vtab.rows == 0);
+    printf("%25s%15s\n", "vtab_free", "success");
+
+    /* a column left without memory grows on the first write */
+    valloc_set_default(&failing_allocator);
+    alloc_budget = 0;
+    assert(vtab_init(&vtab, INIT_CAPACITY * 20, 3, sizes) == VTAB_ERROR);
+    alloc_budget = 3;
+    assert(vtab_init(&vtab, INIT_CAPACITY * 20, 3, sizes) == VTAB_SUCCESS);
+    valloc_set_default(NULL);
+    assert(vtab_column(&vtab, 2)->capacity == 0);
+    alloc_budget = 1;
+    assert(vtab_add_records(&vtab, records, INIT_CAPACITY * 2, sizeof(struct table_record), offsets) == VTAB_SUCCESS);
+    assert(*(const char*)vtab_get(&vtab, 1, 2) == 'b');
+    vtab_free(&vtab);
+    printf("%25s%15s\n", "vtab - no memory", "success");
+}
+
+static void
+void_packed_test() {
+    struct void_packed vpack;
+    uint64_t values[VPACK_BLOCK * 5 + INIT_CAPACITY];
+    uint64_t decoded[VPACK_BLOCK * 5 + INIT_CAPACITY];
+    uint64_t value;
+    unsigned long n = VPACK_BLOCK * 5 + INIT_CAPACITY;
+
+    /* ascending ids, unordered small values, a constant block, full width values and a tail */
+    for (unsigned long i = 0; i < n; i++) {
+        if (i < VPACK_BLOCK) {
+            values[i] = 1000000 + i * 3 + i % 2;
+        } else if (i < VPACK_BLOCK * 2) {
+            values[i] = 500 + (i * 37) % 100;
+        } else if (i < VPACK_BLOCK * 3) {
+            values[i] = 42;
+        } else if (i < VPACK_BLOCK * 4) {
+            values[i] = ~(uint64_t)0 - i * 0x9E3779B97F4A7C15ull;
+        } else {
+            values[i] = i * i;
+        }
+    }
+    assert(vpack_init(&vpack, 1) == VPACK_SUCCESS);
+    assert(vpack_add(&vpack, values, 100) == VPACK_SUCCESS);
+    assert(vpack.blocks.size == 0 && vpack.tail_size == 100);
+    assert(vpack_add(&vpack, values + 100, n - 100) == VPACK_SUCCESS);
+    assert(vpack.size == n);
+    assert(vpack.blocks.size == 5 && vpack.tail_size == INIT_CAPACITY);
+    assert(((const struct vpack_block*)varr_get(&vpack.blocks, 0))->delta);
+    assert(((const struct vpack_block*)varr_get(&vpack.blocks, 0))->bits == 4);
+    assert(!((const struct vpack_block*)varr_get(&vpack.blocks, 1))->delta);
+    assert(((const struct vpack_block*)varr_get(&vpack.blocks, 1))->bits == 7);
+    assert(((const struct vpack_block*)varr_get(&vpack.blocks, 2))->bits == 0);
+    assert(((const struct vpack_block*)varr_get(&vpack.blocks, 3))->bits == 64);
+    printf("%25s%15s\n", "vpack_add", "success");
+
+    for (unsigned long i = 0; i < n; i++) {
+        assert(vpack_get(&vpack, i, &value) == VPACK_SUCCESS);
+        assert(value == values[i]);
+    }
+    assert(vpack_get(&vpack, n, &value) == (VPACK_ERROR ^ VPACK_INDEX_OUT_OF_RANGE));
+    printf("%25s%15s\n", "vpack_get", "success");
+
+    assert(vpack_decode(&vpack, 0, n, decoded) == VPACK_SUCCESS);
+    assert(!memcmp(decoded, values, sizeof(uint64_t) * n));
+    memset(decoded, 0, sizeof(decoded));
+    assert(vpack_decode(&vpack, VPACK_BLOCK - 3, VPACK_BLOCK * 4 + 6, decoded) == VPACK_SUCCESS);
+    assert(!memcmp(decoded, values + VPACK_BLOCK - 3, sizeof(uint64_t) * (VPACK_BLOCK * 4 + 6)));
+    assert(vpack_decode(&vpack, 1, n, decoded) == (VPACK_ERROR ^ VPACK_INDEX_OUT_OF_RANGE));
+    printf("%25s%15s\n", "vpack_decode", "success");
+
+    assert(vpack_clear(&vpack) == VPACK_SUCCESS);
+    assert(vpack.size == 0 && vpack.blocks.size == 0);
+    assert(vpack_add(&vpack, values, VPACK_BLOCK) == VPACK_SUCCESS);
+    assert(vpack_get(&vpack, VPACK_BLOCK - 1, &value) == VPACK_SUCCESS && value == values[VPACK_BLOCK - 1]);
+    vpack_free(&vpack);
+    assert(vpack.blocks.value_bytes == NULL && vpack.words.value_bytes == NULL);
+    printf("%25s%15s\n", "vpack_free", "success");
+
+    /* the zero words missing after a failed init are added on the first seal */
+    valloc_set_default(&failing_allocator);
+    alloc_budget = 0;
+    assert(vpack_init(&vpack, 1) == VPACK_ERROR);
+    valloc_set_default(NULL);
+    assert(vpack.words.size == 0);
+    assert(vpack_add(&vpack, values, VPACK_BLOCK) == VPACK_ERROR);
+    assert(vpack.size == 0 && vpack.blocks.size == 0);
+    alloc_budget = 100;
+    assert(vpack_add(&vpack, values, n) == VPACK_SUCCESS);
+    assert(vpack_decode(&vpack, 0, n, decoded) == VPACK_SUCCESS);
+    assert(!memcmp(decoded, values, sizeof(uint64_t) * n));
+    vpack_free(&vpack);
+    printf("%25s%15s\n", "vpack - no memory", "success");
+}
+
+static void
+void_bitset_test() {
+    struct void_bitset vbits, other;
+    unsigned long n = INIT_CAPACITY * 300;
+    unsigned long count = 0;
+
+    assert(vbits_init(&vbits, n) == VBITS_SUCCESS);
+    assert(vbits.size == n && vbits_count(&vbits) == 0);
+    for (unsigned long i = 0; i < n; i += 7) {
+        assert(vbits_set(&vbits, i) == VBITS_SUCCESS);
+    }
+    assert(vbits_set(&vbits, n) == (VBITS_ERROR ^ VBITS_INDEX_OUT_OF_RANGE));
+    assert(vbits_test(&vbits, 14) && !vbits_test(&vbits, 15) && !vbits_test(&vbits, n));
+    assert(vbits_clear(&vbits, 14) == VBITS_SUCCESS);
+    assert(!vbits_test(&vbits, 14));
+    assert(vbits_set_range(&vbits, 60, 200) == VBITS_SUCCESS);
+    assert(vbits_clear_range(&vbits, 100, 3) == VBITS_SUCCESS);
+    assert(vbits_set_range(&vbits, n - 1, 2) == (VBITS_ERROR ^ VBITS_INDEX_OUT_OF_RANGE));
+    for (unsigned long i = 0; i < n; i++) {
+        int expected = i != 14 && (i % 7 == 0 || (i >= 60 && i < 260 && (i < 100 || i >= 103)));
+        assert(vbits_test(&vbits, i) == expected);
+        count += expected;
+    }
+    assert(vbits_count(&vbits) == count);
+    printf("%25s%15s\n", "vbits_set_range", "success");
+
+    count = 0;
+    for (unsigned long i = 0; i <= n; i++) {
+        assert(vbits_rank(&vbits, i) == count);
+        if (i < n && vbits_test(&vbits, i)) {
+            assert(vbits_select(&vbits, count) == i);
+            count++;
+        }
+    }
+    assert(vbits_select(&vbits, count) == n);
+    assert(vbits_next_set(&vbits, 15) == 21);
+    assert(vbits_next_set(&vbits, 60) == 60);
+    assert(vbits_next_set(&vbits, (n - 1) / 7 * 7 + 1) == n);
+    vbits_set(&vbits, 1);
+    assert(vbits_rank(&vbits, 2) == 2 && vbits_select(&vbits, 1) == 1);
+    printf("%25s%15s\n", "vbits_rank/select", "success");
+
+    assert(vbits_init(&other, n) == VBITS_SUCCESS);
+    assert(vbits_set_range(&other, 0, n / 2) == VBITS_SUCCESS);
+    /* set bits in the second half */
+    count = vbits_count(&vbits) - vbits_rank(&vbits, n / 2);
+    assert(vbits_andnot(&vbits, &other) == VBITS_SUCCESS);
+    assert(vbits_count(&vbits) == count);
+    assert(vbits_next_set(&vbits, 0) >= n / 2);
+    assert(vbits_or(&vbits, &other) == VBITS_SUCCESS);
+    assert(vbits_count(&vbits) == n / 2 + count);
+    assert(vbits_rank(&vbits, n / 2) == n / 2);
+    assert(vbits_xor(&vbits, &other) == VBITS_SUCCESS);
+    assert(vbits_rank(&vbits, n / 2) == 0);
+    assert(vbits_and(&vbits, &other) == VBITS_SUCCESS);
+    assert(vbits_count(&vbits) == 0);
+    assert(vbits_resize(&other, n - 1) == VBITS_SUCCESS);
+    assert(vbits_and(&vbits, &other) == (VBITS_ERROR ^ VBITS_SIZE_MISMATCH));
+    printf("%25s%15s\n", "vbits_and/or/xor", "success");
+
+    /* shrinking clears the bits past the end, growing adds cleared bits */
+    assert(vbits_set_range(&vbits, 0, n) == VBITS_SUCCESS);
+    assert(vbits_resize(&vbits, 70) == VBITS_SUCCESS);
+    assert(vbits_count(&vbits) == 70);
+    assert(vbits_resize(&vbits, n) == VBITS_SUCCESS);
+    assert(vbits_count(&vbits) == 70 && vbits_next_set(&vbits, 70) == n);
+    vbits_free(&vbits);
+    vbits_free(&other);
+    assert(vbits.words.value_bytes == NULL && vbits.size == 0);
+    printf("%25s%15s\n", "vbits_free", "success");
+
+    /* a bitset left without memory grows on the next resize */
+    valloc_set_default(&failing_allocator);
+    alloc_budget = 0;
+    assert(vbits_init(&vbits, n) == VBITS_ERROR);
+    valloc_set_default(NULL);
+    assert(vbits.words.capacity == 0 && vbits.size == 0);
+    alloc_budget = 2;
+    assert(vbits_resize(&vbits, n) == VBITS_SUCCESS);
+    assert(vbits_set(&vbits, n - 1) == VBITS_SUCCESS);
+    assert(vbits_rank(&vbits, n) == 1 && vbits_select(&vbits, 0) == n - 1);
+    vbits_free(&vbits);
+    printf("%25s%15s\n", "vbits - no memory", "success");
+}
+
 int 
 main() 
 {
@@ -166,6 +1453,41 @@ main()
 	void_array_test();
     printf("void_dict_test:\n");
 	void_dict_test();
+    printf("void_range_free_test:\n");
+	void_range_free_test();
+    printf("void_heap_test:\n");
+	void_heap_test();
+#if VARR_INLINE_BYTES > 0 && VDICT_INLINE_BYTES > 0
+    printf("void_small_buffer_test:\n");
+	void_small_buffer_test();
+#endif
+    printf("void_alloc_test:\n");
+	void_alloc_test();
+
+    printf("void_array_concurrent_test:\n");
+	void_array_concurrent_test();
+    printf("void_array_mmap_test:\n");
+	void_array_mmap_test();
+    printf("void_bitset_test:\n");
+	void_bitset_test();
+    printf("void_cow_test:\n");
+	void_cow_test();
+    printf("void_flatmap_test:\n");
+	void_flatmap_test();
+    printf("void_packed_test:\n");
+	void_packed_test();
+    printf("void_parallel_test:\n");
+	void_parallel_test();
+    printf("void_ring_test:\n");
+	void_ring_test();
+    printf("void_slotmap_test:\n");
+	void_slotmap_test();
+    printf("void_table_test:\n");
+	void_table_test();
+    printf("void_telemetry_test:\n");
+	void_telemetry_test();
+    printf("void_vector_test:\n");
+	void_vector_test();
 
     return 0;
 }
@@ -0,0 +1,336 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "void_alloc.h"
+
+/* Every allocation of arenas and pools is aligned to this many bytes */
+#define VALLOC_ALIGN 16
+#define VALLOC_ALIGN_UP(n) (((n) + (VALLOC_ALIGN - 1)) & ~(size_t)(VALLOC_ALIGN - 1))
+
+#define VARENA_HEADER VALLOC_ALIGN_UP(sizeof(struct varena_block))
+#define VARENA_DATA(block) ((unsigned char*)(block) + VARENA_HEADER)
+
+#define VPOOL_MAX_CLASS ((size_t)VPOOL_MIN_CLASS << (VPOOL_CLASSES - 1))
+#define VPOOL_HEADER VALLOC_ALIGN_UP(sizeof(void*))
+
+
+static void*
+stdlib_alloc(void* ctx, size_t size)
+{
+    (void)ctx;
+    return calloc(1, size);
+}
+
+static void*
+stdlib_realloc(void* ctx, void* ptr, size_t old_size, size_t new_size)
+{
+    unsigned char* new_ptr;
+    (void)ctx;
+    new_ptr = (unsigned char*)realloc(ptr, new_size);
+    if (new_ptr && new_size > old_size) {
+        memset(new_ptr + old_size, 0, new_size - old_size);
+    }
+    return new_ptr;
+}
+
+static void
+stdlib_free(void* ctx, void* ptr, size_t size)
+{
+    (void)ctx;
+    (void)size;
+    free(ptr);
+}
+
+const struct void_allocator valloc_stdlib = {
+    stdlib_alloc,
+    stdlib_realloc,
+    stdlib_free,
+    NULL
+};
+
+static const struct void_allocator* valloc_global = &valloc_stdlib;
+
+const struct void_allocator*
+valloc_default(void)
+{
+    return valloc_global;
+}
+
+void
+valloc_set_default(const struct void_allocator* allocator)
+{
+    valloc_global = allocator ? allocator : &valloc_stdlib;
+}
+
+void*
+valloc_alloc(const struct void_allocator* allocator, size_t size)
+{
+    if (!allocator) allocator = valloc_global;
+    return allocator->alloc_fn(allocator->ctx, size);
+}
+
+void*
+valloc_realloc(const struct void_allocator* allocator, void* ptr, size_t old_size, size_t new_size)
+{
+    if (!allocator) allocator = valloc_global;
+    if (!ptr) {
+        return allocator->alloc_fn(allocator->ctx, new_size);
+    }
+    return allocator->realloc_fn(allocator->ctx, ptr, old_size, new_size);
+}
+
+void
+valloc_free(const struct void_allocator* allocator, void* ptr, size_t size)
+{
+    if (!allocator) allocator = valloc_global;
+    if (ptr) {
+        allocator->free_fn(allocator->ctx, ptr, size);
+    }
+}
+
+
+static struct varena_block*
+varena_new_block(struct void_arena* arena, size_t min_size)
+{
+    size_t capacity = arena->block_size > min_size ? arena->block_size : min_size;
+    struct varena_block* block = (struct varena_block*)malloc(VARENA_HEADER + capacity);
+    if (block) {
+        block->prev = arena->head;
+        block->capacity = capacity;
+        block->used = 0;
+        arena->head = block;
+    }
+    return block;
+}
+
+static void*
+varena_alloc(void* ctx, size_t size)
+{
+    struct void_arena* arena = (struct void_arena*)ctx;
+    struct varena_block* block = arena->head;
+    unsigned char* ptr;
+
+    size = VALLOC_ALIGN_UP(size);
+    if (!block || block->capacity - block->used < size) {
+        if (!(block = varena_new_block(arena, size))) {
+            return NULL;
+        }
+    }
+    ptr = VARENA_DATA(block) + block->used;
+    block->used += size;
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+static void*
+varena_realloc(void* ctx, void* ptr, size_t old_size, size_t new_size)
+{
+    struct void_arena* arena = (struct void_arena*)ctx;
+    struct varena_block* block = arena->head;
+    size_t old_aligned = VALLOC_ALIGN_UP(old_size);
+    size_t new_aligned = VALLOC_ALIGN_UP(new_size);
+    unsigned char* new_ptr;
+
+    /* The most recent allocation can be resized in place */
+    if (block && (unsigned char*)ptr + old_aligned == VARENA_DATA(block) + block->used
+            && block->used - old_aligned + new_aligned <= block->capacity) {
+        block->used = block->used - old_aligned + new_aligned;
+        if (new_size > old_size) {
+            memset((unsigned char*)ptr + old_size, 0, new_size - old_size);
+        }
+        return ptr;
+    }
+
+    if ((new_ptr = (unsigned char*)varena_alloc(ctx, new_size))) {
+        memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+    }
+    return new_ptr;
+}
+
+static void
+varena_release(void* ctx, void* ptr, size_t size)
+{
+    struct void_arena* arena = (struct void_arena*)ctx;
+    struct varena_block* block = arena->head;
+    size_t aligned = VALLOC_ALIGN_UP(size);
+
+    if (block && (unsigned char*)ptr + aligned == VARENA_DATA(block) + block->used) {
+        block->used -= aligned;
+    }
+}
+
+int
+varena_init(struct void_arena* arena, size_t block_size)
+{
+    if (arena) {
+        arena->head = NULL;
+        arena->block_size = VALLOC_ALIGN_UP(block_size);
+        arena->allocator.alloc_fn = varena_alloc;
+        arena->allocator.realloc_fn = varena_realloc;
+        arena->allocator.free_fn = varena_release;
+        arena->allocator.ctx = arena;
+        return VALLOC_SUCCESS;
+    }
+    return VALLOC_ERROR ^ VALLOC_ALLOCATOR_404;
+}
+
+void
+varena_reset(struct void_arena* arena)
+{
+    struct varena_block* block = arena->head;
+    if (block) {
+        struct varena_block* prev = block->prev;
+        while (prev) {
+            struct varena_block* tmp = prev->prev;
+            free(prev);
+            prev = tmp;
+        }
+        block->prev = NULL;
+        block->used = 0;
+    }
+}
+
+void
+varena_free(void* arena_ptr)
+{
+    struct void_arena* arena = (struct void_arena*)arena_ptr;
+    varena_reset(arena);
+    free(arena->head);
+    arena->head = NULL;
+    arena->block_size = 0;
+}
+
+
+static inline unsigned
+vpool_class(size_t size)
+{
+    unsigned cls = 0;
+    size_t cls_size = VPOOL_MIN_CLASS;
+    while (cls_size < size) {
+        cls_size <<= 1;
+        cls++;
+    }
+    return cls;
+}
+
+static void*
+vpool_alloc(void* ctx, size_t size)
+{
+    struct void_pool* pool = (struct void_pool*)ctx;
+    unsigned cls;
+    void* chunk;
+
+    if (size > VPOOL_MAX_CLASS) {
+        return valloc_stdlib.alloc_fn(NULL, size);
+    }
+
+    cls = vpool_class(size);
+    if (!pool->free_lists[cls]) {
+        /* Carves a new slab into chunks of the requested class */
+        size_t cls_size = (size_t)VPOOL_MIN_CLASS << cls;
+        unsigned char* slab = (unsigned char*)malloc(pool->slab_size);
+        if (!slab) {
+            return NULL;
+        }
+        *(void**)slab = pool->slabs;
+        pool->slabs = slab;
+        for (size_t offset = VPOOL_HEADER; offset + cls_size <= pool->slab_size; offset += cls_size) {
+            *(void**)(slab + offset) = pool->free_lists[cls];
+            pool->free_lists[cls] = slab + offset;
+        }
+    }
+
+    chunk = pool->free_lists[cls];
+    pool->free_lists[cls] = *(void**)chunk;
+    memset(chunk, 0, size);
+    return chunk;
+}
+
+static void
+vpool_release(void* ctx, void* ptr, size_t size)
+{
+    struct void_pool* pool = (struct void_pool*)ctx;
+    unsigned cls;
+
+    if (size > VPOOL_MAX_CLASS) {
+        valloc_stdlib.free_fn(NULL, ptr, size);
+        return;
+    }
+    cls = vpool_class(size);
+    *(void**)ptr = pool->free_lists[cls];
+    pool->free_lists[cls] = ptr;
+}
+
+static void*
+vpool_realloc(void* ctx, void* ptr, size_t old_size, size_t new_size)
+{
+    unsigned char* new_ptr;
+
+    if (old_size > VPOOL_MAX_CLASS && new_size > VPOOL_MAX_CLASS) {
+        return valloc_stdlib.realloc_fn(NULL, ptr, old_size, new_size);
+    }
+    if (old_size <= VPOOL_MAX_CLASS && new_size <= VPOOL_MAX_CLASS
+            && vpool_class(old_size) == vpool_class(new_size)) {
+        if (new_size > old_size) {
+            memset((unsigned char*)ptr + old_size, 0, new_size - old_size);
+        }
+        return ptr;
+    }
+
+    if ((new_ptr = (unsigned char*)vpool_alloc(ctx, new_size))) {
+        memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+        vpool_release(ctx, ptr, old_size);
+    }
+    return new_ptr;
+}
+
+int
+vpool_init(struct void_pool* pool, size_t slab_size)
+{
+    if (pool) {
+        pool->slabs = NULL;
+        memset(pool->free_lists, 0, sizeof(pool->free_lists));
+        if (slab_size < VPOOL_HEADER + VPOOL_MAX_CLASS) {
+            slab_size = VPOOL_HEADER + VPOOL_MAX_CLASS;
+        }
+        pool->slab_size = slab_size;
+        pool->allocator.alloc_fn = vpool_alloc;
+        pool->allocator.realloc_fn = vpool_realloc;
+        pool->allocator.free_fn = vpool_release;
+        pool->allocator.ctx = pool;
+        return VALLOC_SUCCESS;
+    }
+    return VALLOC_ERROR ^ VALLOC_ALLOCATOR_404;
+}
+
+void
+vpool_free(void* pool_ptr)
+{
+    struct void_pool* pool = (struct void_pool*)pool_ptr;
+    void* slab = pool->slabs;
+    while (slab) {
+        void* next = *(void**)slab;
+        free(slab);
+        slab = next;
+    }
+    pool->slabs = NULL;
+    memset(pool->free_lists, 0, sizeof(pool->free_lists));
+    pool->slab_size = 0;
+}
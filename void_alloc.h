@@ -0,0 +1,200 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#ifndef VAL_VOID_ALLOC_H
+#define VAL_VOID_ALLOC_H
+
+#include <stdlib.h>
+
+/**
+ * Error Codes
+ */
+#define VALLOC_SUCCESS              0
+#define VALLOC_ERROR                1
+#define VALLOC_ALLOCATOR_404        2
+#define VALLOC_OUT_OF_MEMORY        3
+
+/**
+ * Amount of size classes of a Void Pool.
+ * Classes start at `VPOOL_MIN_CLASS` bytes and double per class.
+ */
+#define VPOOL_CLASSES               9
+#define VPOOL_MIN_CLASS             16
+
+/**
+ * Void Allocator Structure
+ * All memory handed out has to be zeroed (calloc semantics),
+ * grown memory of `realloc_fn` has to be zeroed past `old_size`.
+ */
+struct void_allocator {
+    /** allocates `size` zeroed bytes: (ctx, size) */
+    void*(*alloc_fn)(void*, size_t);
+    /** resizes an allocation from `old_size` to `new_size` bytes: (ctx, ptr, old_size, new_size) */
+    void*(*realloc_fn)(void*, void*, size_t, size_t);
+    /** releases an allocation of `size` bytes: (ctx, ptr, size) */
+    void(*free_fn)(void*, void*, size_t);
+    /** user context passed to every function */
+    void* ctx;
+};
+
+/**
+ * Void Arena Block Structure
+ */
+struct varena_block {
+    /** previously filled block */
+    struct varena_block* prev;
+    /** usable bytes of the block */
+    size_t capacity;
+    /** bytes already handed out */
+    size_t used;
+};
+
+/**
+ * Void Arena Structure
+ * Bump allocator, freeing single allocations is a no-op
+ * unless it is the most recent one.
+ */
+struct void_arena {
+    /** block currently allocated from */
+    struct varena_block* head;
+    /** default size of newly allocated blocks in bytes */
+    size_t block_size;
+    /** allocator interface backed by this arena */
+    struct void_allocator allocator;
+};
+
+/**
+ * Void Pool Structure
+ * Size-class allocator with one intrusive free list per class,
+ * larger requests are passed on to the default allocator.
+ */
+struct void_pool {
+    /** list of all allocated slabs */
+    void* slabs;
+    /** free lists of all size classes */
+    void* free_lists[VPOOL_CLASSES];
+    /** size of newly allocated slabs in bytes */
+    size_t slab_size;
+    /** allocator interface backed by this pool */
+    struct void_allocator allocator;
+};
+
+/**
+ * Allocator wrapping `calloc`, `realloc` and `free`.
+ */
+extern const struct void_allocator valloc_stdlib;
+
+/**
+ * Returns the allocator used by containers which are initialized
+ * without an explicit allocator.
+ *
+ * @return Default Allocator
+ */
+const struct void_allocator*
+valloc_default(void);
+
+/**
+ * Sets the allocator used by containers which are initialized
+ * without an explicit allocator.
+ * Containers keep the allocator they were initialized with.
+ *
+ * @param allocator New Default Allocator (NULL restores `valloc_stdlib`)
+ */
+void
+valloc_set_default(const struct void_allocator* allocator);
+
+/**
+ * Allocates `size` zeroed bytes with `allocator`.
+ *
+ * @param allocator Allocator to use (NULL for the default allocator)
+ * @param size Amount of bytes
+ * @return Pointer to allocated memory (NULL on failure)
+ */
+void*
+valloc_alloc(const struct void_allocator* allocator, size_t size);
+
+/**
+ * Resizes `ptr` from `old_size` to `new_size` bytes with `allocator`.
+ *
+ * @param allocator Allocator `ptr` was allocated with (NULL for the default allocator)
+ * @param ptr Allocation to resize (Nullable)
+ * @param old_size Current size of the allocation
+ * @param new_size Requested size of the allocation
+ * @return Pointer to resized memory (NULL on failure, `ptr` stays valid)
+ */
+void*
+valloc_realloc(const struct void_allocator* allocator, void* ptr, size_t old_size, size_t new_size);
+
+/**
+ * Releases `ptr` of `size` bytes with `allocator`.
+ *
+ * @param allocator Allocator `ptr` was allocated with (NULL for the default allocator)
+ * @param ptr Allocation to release (Nullable)
+ * @param size Size of the allocation
+ */
+void
+valloc_free(const struct void_allocator* allocator, void* ptr, size_t size);
+
+/**
+ * Initializes a Void Arena.
+ * Blocks are only allocated once the first allocation is made.
+ *
+ * @param arena Void Arena to be initialized
+ * @param block_size Default size of blocks in bytes
+ * @return Error Code
+ */
+int
+varena_init(struct void_arena* arena, size_t block_size);
+
+/**
+ * Invalidates all allocations of `arena` at once and keeps
+ * the most recent block for reuse.
+ *
+ * @param arena Void Arena to reset
+ */
+void
+varena_reset(struct void_arena* arena);
+
+/**
+ * Assumes `arena_ptr` is of type `struct void_arena*`.
+ * Frees all blocks of the arena.
+ *
+ * @param arena_ptr Void Arena to be freed
+ */
+void
+varena_free(void* arena_ptr);
+
+/**
+ * Initializes a Void Pool.
+ *
+ * @param pool Void Pool to be initialized
+ * @param slab_size Size of slabs carved into size classes (at least the largest class)
+ * @return Error Code
+ */
+int
+vpool_init(struct void_pool* pool, size_t slab_size);
+
+/**
+ * Assumes `pool_ptr` is of type `struct void_pool*`.
+ * Frees all slabs of the pool.
+ * Allocations larger than the largest size class have to be freed beforehand.
+ *
+ * @param pool_ptr Void Pool to be freed
+ */
+void
+vpool_free(void* pool_ptr);
+
+#endif /* VAL_VOID_ALLOC_H */
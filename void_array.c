@@ -19,7 +19,9 @@
 #include <stdint.h>
 #include <string.h>
 
+#define VA_VOID_ARRAY_C
 #include "void_array.h"
+#include "void_telemetry.h"
 
 static const unsigned long mbi = sizeof(unsigned long) * CHAR_BIT;
 static const unsigned long xbi = mbi >> 4;
@@ -50,43 +52,118 @@ ceiled_log2(register const unsigned long val)
     return sb;
 }
 
+/* Repoints `value_bytes` at the small buffer in case the structure was copied */
+static inline void 
+varr_sync(struct void_array* const varray) 
+{
+#if VARR_INLINE_BYTES > 0
+    if (varray->is_inline) {
+        varray->value_bytes = varray->inline_bytes.bytes;
+    }
+#else
+    (void)varray;
+#endif
+}
+
+static inline void 
+varr_destroy(struct void_array* const varray, const unsigned long idx, const unsigned long n) 
+{
+    if (n) {
+        if (varray->range_free_fn) {
+            varray->range_free_fn((unsigned char*)varray->value_bytes + varray->value_size * idx, n, varray->value_size);
+        } else if (varray->value_free_fn) {
+            for (unsigned long i=0; i < n; i++) {
+                varray->value_free_fn((unsigned char*)varray->value_bytes + varray->value_size * (idx + i));
+            }
+        }
+    }
+}
+
 static inline unsigned long 
 needed_doublings(const struct void_array* const varray, const unsigned long n) 
 {
-    return ceiled_log2((varray->size + n) / varray->capacity + 1);
+    const unsigned long needed = varray->size + n;
+    if (!varray->capacity) {
+        /* the first doubling only gets the capacity to 1 */
+        return needed ? ceiled_log2(needed) + 1 : 0;
+    }
+    return needed > varray->capacity ? ceiled_log2((needed - 1) / varray->capacity + 1) : 0;
 }
 
 void 
 varr_expand(struct void_array* const varray, const unsigned long doublings) 
 {
     if (doublings > 0) {
-        void* tmp = varray->value_bytes;
-        if (((1ul - 1) >> 1) > varray->capacity) {
-            varray->capacity = varray->capacity << doublings;
+        unsigned long capacity;
+        void* tmp;
+        varr_sync(varray);
+        /* shifting by the width of the type is undefined, the clamped shift saturates the same way */
+        const unsigned long shift = doublings < sizeof(unsigned long) * 8 ? doublings : sizeof(unsigned long) * 8 - 1;
+        if (!varray->capacity) {
+            /* left without memory by a failed initial allocation */
+            capacity = doublings <= sizeof(unsigned long) * 8 ? 1ul << (doublings - 1) : (unsigned long)-1;
+        } else if (doublings == shift && (-1ul >> shift) > varray->capacity) {
+            capacity = varray->capacity << shift;
         } else {
-            varray->capacity = -1;
+            capacity = (unsigned long)-1;
+        }
+#if VARR_INLINE_BYTES > 0
+        if (varray->is_inline) {
+            if (varray->value_size * capacity <= VARR_INLINE_BYTES) {
+                varray->capacity = capacity;
+                return;
+            }
+            /* Spills the small buffer onto the heap */
+            if ((tmp = valloc_alloc(varray->allocator, varray->value_size * capacity))) {
+                VTELEM_ALLOC(VTELEM_ARRAY, varray->value_size * capacity);
+                memcpy(tmp, varray->value_bytes, varray->value_size * varray->size);
+                varray->value_bytes = tmp;
+                varray->capacity = capacity;
+                varray->is_inline = 0;
+            }
+            return;
+        }
+#endif
+        tmp = valloc_realloc(varray->allocator, varray->value_bytes, 
+                varray->value_size * varray->capacity, varray->value_size * capacity);
+        if (tmp) {
+            VTELEM_REALLOC(VTELEM_ARRAY, varray->value_size * varray->capacity, varray->value_size * capacity);
+            varray->value_bytes = tmp;
+            varray->capacity = capacity;
         }
-        varray->value_bytes = calloc(varray->value_size, varray->capacity);
-        memcpy(varray->value_bytes, tmp, varray->value_size * varray->size);
-        free(tmp);
     }
 }
 
 void 
 varr_shrink(struct void_array* const varray) 
 {
-    void* tmp = varray->value_bytes;
-    varray->capacity = varray->size;
-    varray->value_bytes = calloc(varray->value_size, varray->capacity);
-    memcpy(varray->value_bytes, tmp, varray->value_size * varray->size);
-    free(tmp);
+    void* tmp;
+#if VARR_INLINE_BYTES > 0
+    if (varray->is_inline) {
+        varr_sync(varray);
+        varray->capacity = varray->size;
+        return;
+    }
+#endif
+    tmp = valloc_realloc(varray->allocator, varray->value_bytes, 
+            varray->value_size * varray->capacity, varray->value_size * varray->size);
+    if (tmp || !varray->size) {
+        VTELEM_REALLOC(VTELEM_ARRAY, varray->value_size * varray->capacity, varray->value_size * varray->size);
+        varray->value_bytes = tmp;
+        varray->capacity = varray->size;
+    }
 }
 
 int 
 varr_add(struct void_array* const varray, const void* const data, const unsigned long n) 
 {
     if (varray) {
+        varr_sync(varray);
         varr_expand(varray, needed_doublings(varray, n));
+        /* a failed reallocation leaves the capacity unchanged */
+        if (varray->size + n > varray->capacity) {
+            return VARR_ERROR;
+        }
         memcpy((unsigned char*)varray->value_bytes + varray->value_size * varray->size, data, varray->value_size * n);
         varray->size += n;
         return VARR_SUCCESS;
@@ -98,11 +175,17 @@ int
 varr_insert(struct void_array* const varray, const unsigned long idx, const void* const data, const unsigned long n)
 {
     if (varray) {
+        varr_sync(varray);
         if (idx < varray->size) {
             varr_expand(varray, needed_doublings(varray, n));
-            if (idx != varray->size - 1) {
-                memmove((unsigned char*)varray->value_bytes + varray->value_size * (idx + n), (unsigned char*)varray->value_bytes + varray->value_size * idx, varray->value_size * n);
+            if (varray->size + n > varray->capacity) {
+                return VARR_ERROR;
             }
+            /* Moving all Elements from `idx` on `n` to the right, thus opening a gap */
+            memmove((unsigned char*)varray->value_bytes + varray->value_size * (idx + n), 
+                (unsigned char*)varray->value_bytes + varray->value_size * idx,
+                varray->value_size * (varray->size - idx));
+            VTELEM_MOVE(VTELEM_ARRAY, varray->value_size * (varray->size - idx));
             memcpy((unsigned char*)varray->value_bytes + varray->value_size * idx, data, varray->value_size * n);
             varray->size += n;
             return VARR_SUCCESS;
@@ -116,11 +199,10 @@ int
 varr_fill(struct void_array* const varray, const unsigned long idx, void* const data, const unsigned long n) 
 {
     if (varray) {
+        varr_sync(varray);
         if (idx <= varray->size && idx + n <= varray->capacity) {
+            varr_destroy(varray, idx, idx + n < varray->size ? n : varray->size - idx);
             for (unsigned long i=0; i < n; i++) {
-                if (varray->value_free_fn) {
-                    varray->value_free_fn((unsigned char*)varray->value_bytes + varray->value_size * (idx + i));
-                }
                 memcpy((unsigned char*)varray->value_bytes + varray->value_size * (idx + i), data, varray->value_size);
             }
             varray->size = idx + n;
@@ -135,12 +217,9 @@ int
 varr_replace(struct void_array* const varray, const unsigned long idx, void* const data, const unsigned long n)
 {
     if (varray) {
+        varr_sync(varray);
         if (idx + n <= varray->size) {
-            if (varray->value_free_fn) {
-                for (unsigned long i=0; i < n; i++) {
-                    varray->value_free_fn((unsigned char*)varray->value_bytes + varray->value_size * (idx + i));
-                }
-            }
+            varr_destroy(varray, idx, n);
             memcpy((unsigned char*)varray->value_bytes + varray->value_size * idx, data, varray->value_size * n);
             return VARR_SUCCESS;
         }
@@ -149,31 +228,20 @@ varr_replace(struct void_array* const varray, const unsigned long idx, void* con
     return VARR_ERROR ^ VARR_ARRAY_404;
 }
 
-const void*
-varr_get(const struct void_array* const varray, const unsigned long idx) 
-{
-    if (idx < varray->size) {
-        return (unsigned char*)varray->value_bytes + varray->value_size * idx;
-    }
-    return NULL;
-}
-
 int 
 varr_remove(struct void_array* const varray, const unsigned long idx, const unsigned long n) 
 {
     if (varray) {
+        varr_sync(varray);
         if (idx + n <= varray->size) {
-            if (varray->value_free_fn) {
-                for (unsigned long i=0; i < n; i++) {
-                    varray->value_free_fn((unsigned char*)varray->value_bytes + varray->value_size * (idx + i));
-                }
-            }
+            varr_destroy(varray, idx, n);
 
             if (idx != varray->size - 1) {
                 /* Moving Memory one to the left, thus deleting the given Element */
                 memmove((unsigned char*)varray->value_bytes + varray->value_size * idx, 
                     (unsigned char*)varray->value_bytes + varray->value_size * (idx + n),
                     varray->value_size * (varray->size - idx - n));
+                VTELEM_MOVE(VTELEM_ARRAY, varray->value_size * (varray->size - idx - n));
             }
             varray->size -= n;
             memset((unsigned char*)varray->value_bytes + (varray->value_size * varray->size), 0, varray->value_size * n);
@@ -189,27 +257,65 @@ int
 varr_clear(struct void_array* const varray) 
 {
     if (varray) {
-        if (varray->value_free_fn) {
-            for (unsigned long idx = 0; idx < varray->size; idx++) {
-                varray->value_free_fn((unsigned char*)varray->value_bytes + varray->value_size * idx);
-            }
+        varr_sync(varray);
+        varr_destroy(varray, 0, varray->size);
+        if (varray->size) {
+            memset(varray->value_bytes, 0, varray->value_size * varray->size);
         }
-        memset(varray->value_bytes, 0, varray->value_size * varray->size);
         varray->size = 0;
         return VARR_SUCCESS;
     }
     return VARR_ERROR ^ VARR_ARRAY_404;
 }
 
+void 
+varr_set_range_free_fn(struct void_array* const varray, void(* const range_free_fn)(void*, size_t, size_t)) 
+{
+    varray->range_free_fn = range_free_fn;
+}
+
+void 
+varr_range_free_ptrs(void* const base, const size_t n, const size_t stride) 
+{
+    for (size_t i = 0; i < n; i++) {
+        free(*(void**)((unsigned char*)base + stride * i));
+    }
+}
+
 int 
 varr_init(struct void_array* const varray, const unsigned long init_capacity, const unsigned long value_size, void(* const value_free_fn)(void*)) 
+{
+    return varr_init_alloc(varray, init_capacity, value_size, value_free_fn, NULL);
+}
+
+int 
+varr_init_alloc(struct void_array* const varray, const unsigned long init_capacity, const unsigned long value_size, void(* const value_free_fn)(void*), const struct void_allocator* const allocator) 
 {
     if (varray) {
-        varray->value_bytes = calloc(value_size, init_capacity);
+        varray->allocator = allocator ? allocator : valloc_default();
+#if VARR_INLINE_BYTES > 0
+        varray->is_inline = !allocator && value_size * init_capacity <= VARR_INLINE_BYTES;
+        if (varray->is_inline) {
+            memset(varray->inline_bytes.bytes, 0, VARR_INLINE_BYTES);
+            varray->value_bytes = varray->inline_bytes.bytes;
+        } else
+#endif
+        {
+            varray->value_bytes = valloc_alloc(varray->allocator, value_size * init_capacity);
+            if (varray->value_bytes) {
+                VTELEM_ALLOC(VTELEM_ARRAY, value_size * init_capacity);
+            }
+        }
         varray->size = 0;
         varray->capacity = init_capacity;
         varray->value_size = value_size;
         varray->value_free_fn = value_free_fn;
+        varray->range_free_fn = NULL;
+        if (!varray->value_bytes && value_size && init_capacity) {
+            /* an empty Void Array is still safe to free */
+            varray->capacity = 0;
+            return VARR_ERROR;
+        }
         return VARR_SUCCESS;
     }
     return VARR_ERROR ^ VARR_ARRAY_404;
@@ -219,15 +325,25 @@ void
 varr_free(void* varray_ptr) 
 {
     struct void_array* varray = (struct void_array*)varray_ptr;
-    if (varray->value_free_fn) {
-        for (unsigned long idx = 0; idx < varray->size; idx++) {
-            varray->value_free_fn((unsigned char*)varray->value_bytes + varray->value_size * idx);
+    varr_sync(varray);
+    varr_destroy(varray, 0, varray->size);
+#if VARR_INLINE_BYTES > 0
+    if (!varray->is_inline)
+#endif
+    {
+        if (varray->value_bytes) {
+            valloc_free(varray->allocator, varray->value_bytes, varray->value_size * varray->capacity);
+            VTELEM_FREE(VTELEM_ARRAY, varray->value_size * varray->capacity);
         }
     }
-    free(varray->value_bytes);
     varray->value_bytes = NULL;
     varray->capacity = 0;
     varray->size = 0;
     varray->value_size = 0;
     varray->value_free_fn = NULL;
-}
+    varray->range_free_fn = NULL;
+    varray->allocator = NULL;
+#if VARR_INLINE_BYTES > 0
+    varray->is_inline = 0;
+#endif
+}
\ No newline at end of file
@@ -19,6 +19,8 @@
 
 #include <stdlib.h>
 
+#include "void_alloc.h"
+
 /**
  * Error Codes
  */
@@ -27,6 +29,27 @@
 #define VARR_ARRAY_404              2
 #define VARR_INDEX_OUT_OF_RANGE     3
 
+/**
+ * Amount of bytes stored inside the structure itself before values
+ * spill onto the heap, off (0) unless defined at compile time.
+ * While values are stored inline `value_bytes` points into the structure,
+ * so copies of it have to be read through `varr_data`.
+ */
+#ifndef VARR_INLINE_BYTES
+#define VARR_INLINE_BYTES           0
+#endif
+
+/**
+ * Defining `VOID_HEADER_ONLY` turns the hot paths of the Void Array
+ * into `static inline` functions of this header, so compilers can inline
+ * and vectorize element accesses. All other functions stay in void_array.c.
+ */
+#ifdef VOID_HEADER_ONLY
+#define VARR_HOT                    static inline
+#else
+#define VARR_HOT
+#endif
+
 /**
  * Void Array Structure
  */
@@ -36,8 +59,30 @@ struct void_array {
     unsigned long capacity; /** allocated memory of the array */
     unsigned long value_size; /** size of values in bytes */
     void(*value_free_fn)(void*); /** free function for recursive freeing on each value */
+    void(*range_free_fn)(void*, size_t, size_t); /** free function for batched freeing of `n` values from `base` every `stride` bytes */
+    const struct void_allocator* allocator; /** allocator of `value_bytes` */
+#if VARR_INLINE_BYTES > 0
+    int is_inline; /** whether values are stored in `inline_bytes` */
+    union {
+        void* align_ptr;
+        double align_double;
+        unsigned long long align_ull;
+        unsigned char bytes[VARR_INLINE_BYTES];
+    } inline_bytes; /** small buffer used while `value_size * capacity` fits */
+#endif
 };
 
+/**
+ * Returns pointer to the values of `varray`.
+ * Unlike `varray->value_bytes` it stays valid for small buffer
+ * Void Arrays which were copied to another location.
+ */
+#if VARR_INLINE_BYTES > 0
+#define varr_data(varray) ((varray)->is_inline ? (void*)(varray)->inline_bytes.bytes : (varray)->value_bytes)
+#else
+#define varr_data(varray) ((varray)->value_bytes)
+#endif
+
 
 /**
  * Doubles allocated memory of `varray->value_bytes` for `doublings` times
@@ -65,7 +110,7 @@ varr_shrink(struct void_array* const varray);
  * \param varray Void Array to add element to
  * \param data Data to be copied into Void Array
  * \param n Amount of data to be added
- * \return Error Code
+ * \return Error Code (`VARR_ERROR` if the memory couldn't be allocated)
  */
 int 
 varr_add(struct void_array* const varray, const void* const data, const unsigned long n);
@@ -79,7 +124,7 @@ varr_add(struct void_array* const varray, const void* const data, const unsigned
  * @param idx Index to insert data at
  * @param data Data to be copied into Void Array
  * @param n Amount of data to be added
- * @return Error Code
+ * @return Error Code (`VARR_ERROR` if the memory couldn't be allocated)
  */
 int
 varr_insert(struct void_array* const varray, const unsigned long idx, const void* const data, const unsigned long n);
@@ -119,7 +164,7 @@ varr_replace(struct void_array* const varray, const unsigned long idx, void* con
  * @param idx Index of the Element
  * @return Pointer to Element (NULL if idx out of range)
  */
-const void* 
+VARR_HOT const void* 
 varr_get(const struct void_array* const varray, const unsigned long idx);
 
 /**
@@ -146,8 +191,34 @@ varr_remove(struct void_array* const varray, const unsigned long idx, const size
 int 
 varr_clear(struct void_array* const varray);
 
+/**
+ * Sets a range free function which replaces `value_free_fn`.
+ * It is called once per removed range with a pointer to the first
+ * value, the amount of values and `varray->value_size` as stride.
+ * If neither `value_free_fn` nor `range_free_fn` are set, values are
+ * treated as trivially destructible and never visited on removal.
+ *
+ * @param varray Void Array to set the range free function of
+ * @param range_free_fn Function to be called on ranges of values (Nullable)
+ */
+void 
+varr_set_range_free_fn(struct void_array* const varray, void(* const range_free_fn)(void*, size_t, size_t));
+
+/**
+ * Range free function for values which are pointers owned by the container.
+ * Calls `free` on each of the `n` pointers stored `stride` bytes apart from `base`.
+ *
+ * @param base Pointer to the first value
+ * @param n Amount of values
+ * @param stride Distance between values in bytes
+ */
+void 
+varr_range_free_ptrs(void* const base, const size_t n, const size_t stride);
+
 /**
  * Initializes a `void_array` structure.
+ * Values are stored inside the structure as long as they fit
+ * into `VARR_INLINE_BYTES` and no allocator was given.
  * If stored data doesn't need to be freed in any specific
  * manner (ie. non-pointers), `value_free_fn` is to be `NULL`.
  * 
@@ -155,11 +226,26 @@ varr_clear(struct void_array* const varray);
  * @param init_capacity Initial Memory Capacity of the Void Array
  * @param value_size Size of Values to be saved (in Bytes)
  * @param value_free_fn Function to be called when freeing special datatypes (Nullable)
- * @return Error Code
+ * @return Error Code (`VARR_ERROR` if the memory couldn't be allocated)
  */
 int 
 varr_init(struct void_array* const varray, const unsigned long init_capacity, const size_t value_size, void(* const value_free_fn)(void*));
 
+/**
+ * Initializes a `void_array` structure whose memory is managed
+ * by `allocator` instead of the default allocator.
+ * Values are only stored inside the structure if `allocator` is NULL.
+ * 
+ * @param varray Void Array to be initialized
+ * @param init_capacity Initial Memory Capacity of the Void Array
+ * @param value_size Size of Values to be saved (in Bytes)
+ * @param value_free_fn Function to be called when freeing special datatypes (Nullable)
+ * @param allocator Allocator of the Void Array (NULL for the default allocator)
+ * @return Error Code (`VARR_ERROR` if the memory couldn't be allocated)
+ */
+int 
+varr_init_alloc(struct void_array* const varray, const unsigned long init_capacity, const size_t value_size, void(* const value_free_fn)(void*), const struct void_allocator* const allocator);
+
 /**
  * Assumes `varray_ptr` is of type `struct void_array*`.
  * Frees all allocated data and sets all members of the `void_array`
@@ -171,5 +257,15 @@ varr_init(struct void_array* const varray, const unsigned long init_capacity, co
 void 
 varr_free(void* const varray_ptr);
 
+#if defined(VOID_HEADER_ONLY) || defined(VA_VOID_ARRAY_C)
+VARR_HOT const void*
+varr_get(const struct void_array* const varray, const unsigned long idx) 
+{
+    if (idx < varray->size) {
+        return (unsigned char*)varr_data(varray) + varray->value_size * idx;
+    }
+    return NULL;
+}
+#endif
 
 #endif /* VA_VOID_ARRAY_H */
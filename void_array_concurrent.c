@@ -0,0 +1,250 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sched.h>
+
+#include "void_array_concurrent.h"
+#include "void_telemetry.h"
+
+/* Largest amount of reserved values, keeps the chunk arithmetic below from overflowing */
+#define VARR_CONC_MAX_VALUES (SIZE_MAX / 4)
+
+#define CHUNKS(vconc) ((void**)varr_data(&(vconc)->chunks))
+/* values of chunk `k` and index of its first value */
+#define CHUNK_VALUES(vconc, k) ((size_t)1 << ((k) + (vconc)->chunk_bits))
+#define CHUNK_START(vconc, k) ((((size_t)1 << (k)) - 1) << (vconc)->chunk_bits)
+
+/* Directory entry of a chunk which is being allocated */
+static unsigned char varr_conc_busy;
+#define BUSY ((void*)&varr_conc_busy)
+
+/* Chunk holding the value at `idx` (below `VARR_CONC_MAX_VALUES`) */
+static inline unsigned
+varr_conc_chunk(const struct void_array_concurrent* vconc, size_t idx)
+{
+    return (unsigned)(sizeof(unsigned long long) * 8 - 1
+                      - (unsigned)__builtin_clzll((unsigned long long)(idx >> vconc->chunk_bits) + 1));
+}
+
+/*
+ * Takes back the reservation at `start` which can't be stored.
+ * If others reserved behind it already, their values could never be published,
+ * so appending fails from now on.
+ */
+static void
+varr_conc_cancel(struct void_array_concurrent* vconc, size_t start, size_t n)
+{
+    size_t end = start + n;
+    if (!__atomic_compare_exchange_n(&vconc->reserved, &end, start, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+        __atomic_store_n(&vconc->failed, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+/*
+ * Makes sure the chunks up to `last` exist for the reservation at `start`.
+ * Chunks are allocated in order, so every reservation behind a missing chunk needs it as well.
+ * Cancels the reservation if an allocation fails.
+ */
+static int
+varr_conc_alloc_chunks(struct void_array_concurrent* vconc, unsigned last, size_t start, size_t n)
+{
+    void** chunks = CHUNKS(vconc);
+    void* chunk = __atomic_load_n(chunks + last, __ATOMIC_ACQUIRE);
+
+    if (chunk && chunk != BUSY) {
+        return 1;
+    }
+    for (unsigned k = 0; k <= last; k++) {
+        for (;;) {
+            void* expected = NULL;
+            chunk = __atomic_load_n(chunks + k, __ATOMIC_ACQUIRE);
+            if (chunk == BUSY) {
+                sched_yield();
+                continue;
+            }
+            if (chunk) {
+                break;
+            }
+            if (!__atomic_compare_exchange_n(chunks + k, &expected, BUSY, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+                continue;
+            }
+            /* a failed reservation in front may never be published, nothing behind it may be stored */
+            chunk = NULL;
+            if (!__atomic_load_n(&vconc->failed, __ATOMIC_SEQ_CST)
+                    && CHUNK_VALUES(vconc, k) <= SIZE_MAX / vconc->value_size) {
+                chunk = valloc_alloc(vconc->chunks.allocator, vconc->value_size * CHUNK_VALUES(vconc, k));
+            }
+            if (!chunk) {
+                /* still owning the chunk, so no later reservation gets past it before `failed` is set */
+                varr_conc_cancel(vconc, start, n);
+                __atomic_store_n(chunks + k, NULL, __ATOMIC_SEQ_CST);
+                return 0;
+            }
+            VTELEM_ALLOC(VTELEM_ARRAY, vconc->value_size * CHUNK_VALUES(vconc, k));
+            __atomic_store_n(chunks + k, chunk, __ATOMIC_RELEASE);
+            break;
+        }
+    }
+    return 1;
+}
+
+int
+varr_conc_begin(struct void_array_concurrent* vconc, size_t n, size_t* idx)
+{
+    if (vconc) {
+        size_t start = __atomic_fetch_add(&vconc->reserved, n, __ATOMIC_RELAXED);
+
+        *idx = start;
+        if (start + n < start || start + n > VARR_CONC_MAX_VALUES) {
+            varr_conc_cancel(vconc, start, n);
+            return VARR_CONC_ERROR;
+        }
+        if (n && !varr_conc_alloc_chunks(vconc, varr_conc_chunk(vconc, start + n - 1), start, n)) {
+            return VARR_CONC_ERROR;
+        }
+        return VARR_CONC_SUCCESS;
+    }
+    return VARR_CONC_ERROR ^ VARR_CONC_ARRAY_404;
+}
+
+void
+varr_conc_commit(struct void_array_concurrent* vconc, size_t idx, size_t n)
+{
+    while (__atomic_load_n(&vconc->size, __ATOMIC_ACQUIRE) != idx) sched_yield();
+    __atomic_store_n(&vconc->size, idx + n, __ATOMIC_RELEASE);
+}
+
+void*
+varr_conc_at(const struct void_array_concurrent* vconc, size_t idx)
+{
+    if (idx < VARR_CONC_MAX_VALUES) {
+        const unsigned k = varr_conc_chunk(vconc, idx);
+        unsigned char* chunk = (unsigned char*)__atomic_load_n(CHUNKS(vconc) + k, __ATOMIC_ACQUIRE);
+        if (chunk && chunk != BUSY) {
+            return chunk + vconc->value_size * (idx - CHUNK_START(vconc, k));
+        }
+    }
+    return NULL;
+}
+
+/* Copies `n` values from or to the values at `idx`, chunk by chunk */
+static void
+varr_conc_transfer(const struct void_array_concurrent* vconc, size_t idx, size_t n, unsigned char* data, const int store)
+{
+    while (n) {
+        const unsigned k = varr_conc_chunk(vconc, idx);
+        size_t take = CHUNK_START(vconc, k + 1) - idx;
+        if (take > n) {
+            take = n;
+        }
+        if (store) {
+            memcpy(varr_conc_at(vconc, idx), data, vconc->value_size * take);
+        } else {
+            memcpy(data, varr_conc_at(vconc, idx), vconc->value_size * take);
+        }
+        data += vconc->value_size * take;
+        idx += take;
+        n -= take;
+    }
+}
+
+int
+varr_conc_add(struct void_array_concurrent* vconc, const void* data, size_t n)
+{
+    if (vconc) {
+        size_t idx;
+        if (varr_conc_begin(vconc, n, &idx) != VARR_CONC_SUCCESS) {
+            return VARR_CONC_ERROR;
+        }
+        varr_conc_transfer(vconc, idx, n, (unsigned char*)data, 1);
+        varr_conc_commit(vconc, idx, n);
+        return VARR_CONC_SUCCESS;
+    }
+    return VARR_CONC_ERROR ^ VARR_CONC_ARRAY_404;
+}
+
+size_t
+varr_conc_size(const struct void_array_concurrent* vconc)
+{
+    return __atomic_load_n(&vconc->size, __ATOMIC_ACQUIRE);
+}
+
+int
+varr_conc_copy(const struct void_array_concurrent* vconc, size_t idx, size_t n, void* out)
+{
+    if (vconc) {
+        if (idx + n > varr_conc_size(vconc) || idx + n < idx) {
+            return VARR_CONC_ERROR ^ VARR_CONC_INDEX_OUT_OF_RANGE;
+        }
+        varr_conc_transfer(vconc, idx, n, (unsigned char*)out, 0);
+        return VARR_CONC_SUCCESS;
+    }
+    return VARR_CONC_ERROR ^ VARR_CONC_ARRAY_404;
+}
+
+int
+varr_conc_init(struct void_array_concurrent* vconc, unsigned long init_capacity, size_t value_size)
+{
+    if (vconc) {
+        void* first;
+        vconc->chunk_bits = 0;
+        vconc->value_size = value_size;
+        vconc->reserved = 0;
+        vconc->size = 0;
+        vconc->failed = 0;
+        if (!value_size) {
+            return VARR_CONC_ERROR;
+        }
+        while (CHUNK_VALUES(vconc, 0) < init_capacity && CHUNK_VALUES(vconc, 0) < VARR_CONC_MAX_VALUES / 2) {
+            vconc->chunk_bits++;
+        }
+        /* an explicit allocator keeps the directory off the small buffer, so it never moves */
+        if (varr_init_alloc(&vconc->chunks, VARR_CONC_CHUNKS, sizeof(void*), NULL, valloc_default()) != VARR_SUCCESS) {
+            return VARR_CONC_ERROR;
+        }
+        memset(CHUNKS(vconc), 0, sizeof(void*) * VARR_CONC_CHUNKS);
+        vconc->chunks.size = VARR_CONC_CHUNKS;
+        first = CHUNK_VALUES(vconc, 0) <= SIZE_MAX / value_size
+            ? valloc_alloc(vconc->chunks.allocator, value_size * CHUNK_VALUES(vconc, 0)) : NULL;
+        if (!first) {
+            varr_free(&vconc->chunks);
+            return VARR_CONC_ERROR;
+        }
+        VTELEM_ALLOC(VTELEM_ARRAY, value_size * CHUNK_VALUES(vconc, 0));
+        CHUNKS(vconc)[0] = first;
+        return VARR_CONC_SUCCESS;
+    }
+    return VARR_CONC_ERROR ^ VARR_CONC_ARRAY_404;
+}
+
+void
+varr_conc_free(void* vconc_ptr)
+{
+    struct void_array_concurrent* vconc = (struct void_array_concurrent*)vconc_ptr;
+    for (unsigned k = 0; k < vconc->chunks.size; k++) {
+        if (CHUNKS(vconc)[k]) {
+            VTELEM_FREE(VTELEM_ARRAY, vconc->value_size * CHUNK_VALUES(vconc, k));
+            valloc_free(vconc->chunks.allocator, CHUNKS(vconc)[k], vconc->value_size * CHUNK_VALUES(vconc, k));
+        }
+    }
+    varr_free(&vconc->chunks);
+    vconc->reserved = 0;
+    vconc->size = 0;
+    vconc->failed = 0;
+}
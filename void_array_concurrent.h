@@ -0,0 +1,156 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#ifndef VAC_VOID_ARRAY_CONCURRENT_H
+#define VAC_VOID_ARRAY_CONCURRENT_H
+
+#include <stdlib.h>
+
+#include "void_array.h"
+
+/**
+ * Error Codes
+ */
+#define VARR_CONC_SUCCESS           0
+#define VARR_CONC_ERROR             1
+#define VARR_CONC_ARRAY_404         2
+#define VARR_CONC_INDEX_OUT_OF_RANGE 3
+
+/**
+ * Amount of entries of the chunk directory, enough for every index of a `size_t`
+ */
+#define VARR_CONC_CHUNKS            (sizeof(size_t) * 8)
+
+/**
+ * Concurrent Void Array Structure
+ * Any amount of threads may append at the same time.
+ * Producers reserve index ranges with a fetch-add on `reserved` and copy
+ * their values in parallel. Values are published in index order, so
+ * `size` always covers completely written values only.
+ * Values are stored in chunks, chunk `k` holds `2^k` times as many values
+ * as the first one. Chunks are allocated on demand, one producer each, and
+ * published in the directory with a CAS. The directory is allocated once
+ * for all chunks there can be, so values never move: readers never wait and
+ * producers only wait for the allocation of a chunk they write to.
+ * A reservation which can't be stored is taken back. If others reserved
+ * behind it already, appending fails from then on, values published
+ * before stay readable.
+ */
+struct void_array_concurrent {
+    /** chunk directory of `VARR_CONC_CHUNKS` pointers, an entry is set once */
+    struct void_array chunks;
+    /** log2 of the amount of values of the first chunk */
+    unsigned chunk_bits;
+    /** size of values in bytes */
+    size_t value_size;
+    /** amount of indices handed out to producers */
+    size_t reserved;
+    /** amount of published values */
+    size_t size;
+    /** set once a reservation couldn't be stored or taken back */
+    int failed;
+};
+
+/**
+ * Reserves `n` values at the end of the array, their chunks are allocated
+ * on return. They are written through `varr_conc_at` and published with `varr_conc_commit`.
+ *
+ * @param vconc Concurrent Void Array to append to
+ * @param n Amount of values to reserve
+ * @param idx Set to the index of the first reserved value
+ * @return Error Code (`VARR_CONC_ERROR` if out of memory, nothing is to be committed then)
+ */
+int
+varr_conc_begin(struct void_array_concurrent* vconc, size_t n, size_t* idx);
+
+/**
+ * Publishes `n` values reserved at `idx` by `varr_conc_begin`,
+ * once all values in front of them are published.
+ *
+ * @param vconc Concurrent Void Array appended to
+ * @param idx Index returned by `varr_conc_begin`
+ * @param n Amount of values reserved
+ */
+void
+varr_conc_commit(struct void_array_concurrent* vconc, size_t idx, size_t n);
+
+/**
+ * Returns pointer to the reserved or published value at `idx`.
+ * Values never move, the pointer stays valid until `varr_conc_free`.
+ * Values are contiguous up to the end of their chunk only.
+ *
+ * @param vconc Concurrent Void Array to get the value from
+ * @param idx Index of the value
+ * @return Pointer to the value (NULL if its chunk isn't allocated)
+ */
+void*
+varr_conc_at(const struct void_array_concurrent* vconc, size_t idx);
+
+/**
+ * Copies `n` values of `data` to the end of the array.
+ *
+ * @param vconc Concurrent Void Array to append to
+ * @param data Array of values to be copied
+ * @param n Amount of values
+ * @return Error Code
+ */
+int
+varr_conc_add(struct void_array_concurrent* vconc, const void* data, size_t n);
+
+/**
+ * Returns the amount of published values, all of them are completely written.
+ *
+ * @param vconc Concurrent Void Array to get the size of
+ * @return Published size
+ */
+size_t
+varr_conc_size(const struct void_array_concurrent* vconc);
+
+/**
+ * Copies `n` published values from `idx` on into `out`.
+ * Safe while producers append, never waits.
+ *
+ * @param vconc Concurrent Void Array to copy from
+ * @param idx Index of the first value
+ * @param n Amount of values
+ * @param out Memory to copy the values into
+ * @return Error Code
+ */
+int
+varr_conc_copy(const struct void_array_concurrent* vconc, size_t idx, size_t n, void* out);
+
+/**
+ * Initializes a Concurrent Void Array.
+ * The storage is always allocated on the heap.
+ *
+ * @param vconc Concurrent Void Array to be initialized
+ * @param init_capacity Amount of values of the first chunk, rounded up to a power of two
+ * @param value_size Size of Values to be saved (in Bytes, not 0)
+ * @return Error Code (`VARR_CONC_ERROR` if the memory couldn't be allocated, nothing is left to free then)
+ */
+int
+varr_conc_init(struct void_array_concurrent* vconc, unsigned long init_capacity, size_t value_size);
+
+/**
+ * Assumes `vconc_ptr` is of type `struct void_array_concurrent*`.
+ * Frees all allocated data, no producer may be appending anymore.
+ *
+ * @param vconc_ptr Concurrent Void Array of which the content is to be freed
+ */
+void
+varr_conc_free(void* vconc_ptr);
+
+#endif /* VAC_VOID_ARRAY_CONCURRENT_H */
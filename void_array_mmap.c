@@ -0,0 +1,183 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* mremap */
+#endif
+
+#include <stddef.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "void_array_mmap.h"
+
+/**
+ * Context of the allocator backing a file mapped Void Array.
+ */
+struct varr_mmap_file {
+    struct void_allocator allocator;
+    int fd;
+};
+
+static void*
+mmap_alloc(void* ctx, size_t size)
+{
+    struct varr_mmap_file* file = (struct varr_mmap_file*)ctx;
+    struct stat st;
+    void* map;
+
+    if (fstat(file->fd, &st) || ((size_t)st.st_size < size && ftruncate(file->fd, size))) {
+        return NULL;
+    }
+    map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, file->fd, 0);
+    return map == MAP_FAILED ? NULL : map;
+}
+
+static void*
+mmap_realloc(void* ctx, void* ptr, size_t old_size, size_t new_size)
+{
+    struct varr_mmap_file* file = (struct varr_mmap_file*)ctx;
+    void* map;
+    int truncated;
+
+    /* Extending the file zeroes all new bytes */
+    if (new_size > old_size && ftruncate(file->fd, new_size)) {
+        return NULL;
+    }
+    if (!new_size) {
+        munmap(ptr, old_size);
+        truncated = ftruncate(file->fd, 0);
+        (void)truncated;
+        return NULL;
+    }
+#ifdef MREMAP_MAYMOVE
+    map = mremap(ptr, old_size, new_size, MREMAP_MAYMOVE);
+#else
+    munmap(ptr, old_size);
+    map = mmap(NULL, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, file->fd, 0);
+#endif
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+    if (new_size < old_size) {
+        /* A failed truncate only leaves unused bytes at the end of the file */
+        truncated = ftruncate(file->fd, new_size);
+        (void)truncated;
+    }
+    return map;
+}
+
+static void
+mmap_free(void* ctx, void* ptr, size_t size)
+{
+    (void)ctx;
+    munmap(ptr, size);
+}
+
+static inline struct varr_mmap_file*
+mmap_file(const struct void_array* const varray)
+{
+    if (varray->allocator && varray->allocator->alloc_fn == mmap_alloc) {
+        return (struct varr_mmap_file*)varray->allocator->ctx;
+    }
+    return NULL;
+}
+
+int
+varr_mmap_open(struct void_array* const varray, const char* const path, const unsigned long init_capacity, const size_t value_size)
+{
+    struct varr_mmap_file* file;
+    struct stat st;
+    unsigned long stored, capacity;
+
+    if (!varray) {
+        return VARR_ERROR ^ VARR_ARRAY_404;
+    }
+    if (!value_size) {
+        return VARR_ERROR;
+    }
+    if (!(file = (struct varr_mmap_file*)malloc(sizeof(struct varr_mmap_file)))) {
+        return VARR_ERROR;
+    }
+    if ((file->fd = open(path, O_RDWR | O_CREAT, 0644)) < 0) {
+        free(file);
+        return VARR_ERROR ^ VARR_FILE_ERROR;
+    }
+    if (fstat(file->fd, &st) || (size_t)st.st_size % value_size) {
+        close(file->fd);
+        free(file);
+        return VARR_ERROR ^ VARR_FILE_ERROR;
+    }
+    file->allocator.alloc_fn = mmap_alloc;
+    file->allocator.realloc_fn = mmap_realloc;
+    file->allocator.free_fn = mmap_free;
+    file->allocator.ctx = file;
+
+    stored = (size_t)st.st_size / value_size;
+    capacity = stored > init_capacity ? stored : init_capacity;
+    if (!capacity) capacity = 1;
+
+    varr_init_alloc(varray, capacity, value_size, NULL, &file->allocator);
+    if (!varray->value_bytes) {
+        close(file->fd);
+        free(file);
+        varray->allocator = NULL;
+        return VARR_ERROR ^ VARR_FILE_ERROR;
+    }
+    varray->size = stored;
+    return VARR_SUCCESS;
+}
+
+int
+varr_mmap_sync(struct void_array* const varray)
+{
+    if (varray) {
+        if (!mmap_file(varray)) {
+            return VARR_ERROR ^ VARR_FILE_ERROR;
+        }
+        if (msync(varray->value_bytes, varray->value_size * varray->capacity, MS_SYNC)) {
+            return VARR_ERROR ^ VARR_FILE_ERROR;
+        }
+        return VARR_SUCCESS;
+    }
+    return VARR_ERROR ^ VARR_ARRAY_404;
+}
+
+int
+varr_mmap_close(struct void_array* const varray)
+{
+    struct varr_mmap_file* file;
+    size_t bytes;
+    int ret;
+
+    if (!varray) {
+        return VARR_ERROR ^ VARR_ARRAY_404;
+    }
+    if (!(file = mmap_file(varray))) {
+        return VARR_ERROR ^ VARR_FILE_ERROR;
+    }
+    ret = varr_mmap_sync(varray);
+    bytes = varray->value_size * varray->size;
+    varr_free(varray);
+    if (ftruncate(file->fd, bytes) || close(file->fd)) {
+        ret = VARR_ERROR ^ VARR_FILE_ERROR;
+    }
+    free(file);
+    return ret;
+}
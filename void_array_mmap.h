@@ -0,0 +1,66 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#ifndef VA_VOID_ARRAY_MMAP_H
+#define VA_VOID_ARRAY_MMAP_H
+
+#include "void_array.h"
+
+/**
+ * Error Codes
+ */
+#define VARR_FILE_ERROR             4
+
+/**
+ * Opens or creates the file at `path` and initializes `varray` with
+ * `value_bytes` mapped onto it.
+ * The file holds the raw values without any header, an existing file
+ * is loaded as `varray->size` values and has to be a multiple of `value_size`.
+ * Growing and shrinking the Void Array resizes the file, all other
+ * `varr_*` functions behave as usual.
+ *
+ * @param varray Void Array to be initialized
+ * @param path Path of the backing file
+ * @param init_capacity Minimal Initial Memory Capacity of the Void Array
+ * @param value_size Size of Values to be saved (in Bytes, `VARR_ERROR` if 0)
+ * @return Error Code
+ */
+int
+varr_mmap_open(struct void_array* const varray, const char* const path, const unsigned long init_capacity, const size_t value_size);
+
+/**
+ * Writes all values of a file backed Void Array to disk and
+ * blocks until they are stored.
+ * The file keeps its full capacity until `varr_mmap_close`.
+ *
+ * @param varray File backed Void Array to synchronize
+ * @return Error Code
+ */
+int
+varr_mmap_sync(struct void_array* const varray);
+
+/**
+ * Synchronizes a file backed Void Array, truncates the file to
+ * `varray->size` values, unmaps it and frees the Void Array.
+ * Has to be used instead of `varr_free`.
+ *
+ * @param varray File backed Void Array to close
+ * @return Error Code
+ */
+int
+varr_mmap_close(struct void_array* const varray);
+
+#endif /* VA_VOID_ARRAY_MMAP_H */
@@ -0,0 +1,457 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#include <stddef.h>
+#include <string.h>
+
+/* AVX2 and BMI2 paths are compiled for every x86-64 build and picked at runtime */
+#if defined(__GNUC__) && defined(__x86_64__)
+#define VBITS_X86
+#include <immintrin.h>
+#endif
+
+#include "void_bitset.h"
+
+#define VBITS_OP_AND 0
+#define VBITS_OP_OR 1
+#define VBITS_OP_XOR 2
+#define VBITS_OP_ANDNOT 3
+
+#define WORDS_PER_RANK (VBITS_RANK_BITS / 64)
+
+#define WORDS(vbits) ((uint64_t*)varr_data(&(vbits)->words))
+#define RANKS(vbits) ((unsigned long*)varr_data(&(vbits)->ranks))
+
+#ifdef VBITS_X86
+#ifdef __AVX2__
+#define HAS_AVX2() 1
+#else
+#define HAS_AVX2() __builtin_cpu_supports("avx2")
+#endif
+#ifdef __BMI2__
+#define HAS_BMI2() 1
+#else
+#define HAS_BMI2() __builtin_cpu_supports("bmi2")
+#endif
+#endif
+
+static inline unsigned long
+vbits_word_count(const unsigned long n_bits)
+{
+    return (n_bits + 63) / 64;
+}
+
+/* Mask of the bits from `from` (inclusive) to `to` (exclusive) of one word, `to` may be 64 */
+static inline uint64_t
+vbits_mask(const unsigned from, const unsigned to)
+{
+    return (to == 64 ? ~UINT64_C(0) : (UINT64_C(1) << to) - 1) & (~UINT64_C(0) << from);
+}
+
+#ifdef VBITS_X86
+/* Popcount of every 64 bit lane via nibble lookups (Mula, Kurz and Lemire) */
+static inline __attribute__((target("avx2"))) __m256i
+vbits_popcount256(const __m256i v)
+{
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    const __m256i lo = _mm256_and_si256(v, nibble);
+    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+    const __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+    return _mm256_sad_epu8(bytes, _mm256_setzero_si256());
+}
+
+/* Popcount of `n` words, `n` is a multiple of 4 */
+static __attribute__((target("avx2"))) unsigned long
+vbits_popcount_avx2(const uint64_t* words, const unsigned long n)
+{
+    __m256i acc = _mm256_setzero_si256();
+    for (unsigned long i = 0; i < n; i += 4) {
+        acc = _mm256_add_epi64(acc, vbits_popcount256(_mm256_loadu_si256((const __m256i*)(words + i))));
+    }
+    return (unsigned long)(_mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1)
+                           + _mm256_extract_epi64(acc, 2) + _mm256_extract_epi64(acc, 3));
+}
+
+/* `op` on `n` words, `n` is a multiple of 4 */
+static __attribute__((target("avx2"))) void
+vbits_words_op_avx2(uint64_t* dst, const uint64_t* src, const unsigned long n, const int op)
+{
+    for (unsigned long i = 0; i < n; i += 4) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(dst + i));
+        const __m256i b = _mm256_loadu_si256((const __m256i*)(src + i));
+        switch (op) {
+        case VBITS_OP_AND: a = _mm256_and_si256(a, b); break;
+        case VBITS_OP_OR: a = _mm256_or_si256(a, b); break;
+        case VBITS_OP_XOR: a = _mm256_xor_si256(a, b); break;
+        default: a = _mm256_andnot_si256(b, a); break;
+        }
+        _mm256_storeu_si256((__m256i*)(dst + i), a);
+    }
+}
+
+static __attribute__((target("bmi2"))) unsigned
+vbits_select_word_bmi2(const uint64_t word, const unsigned long k)
+{
+    return (unsigned)__builtin_ctzll(_pdep_u64(UINT64_C(1) << k, word));
+}
+#endif
+
+static unsigned long
+vbits_popcount(const uint64_t* words, const unsigned long n)
+{
+    unsigned long count = 0;
+    unsigned long i = 0;
+#ifdef VBITS_X86
+    if (HAS_AVX2()) {
+        i = n / 4 * 4;
+        count = vbits_popcount_avx2(words, i);
+    }
+#endif
+    for (; i < n; i++) {
+        count += (unsigned long)__builtin_popcountll(words[i]);
+    }
+    return count;
+}
+
+static void
+vbits_words_op(uint64_t* dst, const uint64_t* src, const unsigned long n, const int op)
+{
+    unsigned long i = 0;
+#ifdef VBITS_X86
+    if (HAS_AVX2()) {
+        i = n / 4 * 4;
+        vbits_words_op_avx2(dst, src, i, op);
+    }
+#endif
+    for (; i < n; i++) {
+        switch (op) {
+        case VBITS_OP_AND: dst[i] &= src[i]; break;
+        case VBITS_OP_OR: dst[i] |= src[i]; break;
+        case VBITS_OP_XOR: dst[i] ^= src[i]; break;
+        default: dst[i] &= ~src[i]; break;
+        }
+    }
+}
+
+static int
+vbits_op(struct void_bitset* dst, const struct void_bitset* src, const int op)
+{
+    if (dst && src) {
+        if (dst->size != src->size) {
+            return VBITS_ERROR ^ VBITS_SIZE_MISMATCH;
+        }
+        vbits_words_op(WORDS(dst), WORDS(src), dst->words.size, op);
+        dst->dirty = 1;
+        return VBITS_SUCCESS;
+    }
+    return VBITS_ERROR ^ VBITS_BITSET_404;
+}
+
+/* Sets (`value` 1) or clears the bits from `idx` to `idx + n` */
+static int
+vbits_fill(struct void_bitset* vbits, const unsigned long idx, const unsigned long n, const int value)
+{
+    if (vbits) {
+        uint64_t* words;
+        unsigned long first, last;
+
+        if (idx + n > vbits->size || idx + n < idx) {
+            return VBITS_ERROR ^ VBITS_INDEX_OUT_OF_RANGE;
+        }
+        if (!n) {
+            return VBITS_SUCCESS;
+        }
+        words = WORDS(vbits);
+        first = idx / 64;
+        last = (idx + n - 1) / 64;
+        if (first == last) {
+            const uint64_t mask = vbits_mask(idx % 64, (unsigned)((idx + n - 1) % 64 + 1));
+            words[first] = value ? words[first] | mask : words[first] & ~mask;
+        } else {
+            const uint64_t head = vbits_mask(idx % 64, 64);
+            const uint64_t tail = vbits_mask(0, (unsigned)((idx + n - 1) % 64 + 1));
+            words[first] = value ? words[first] | head : words[first] & ~head;
+            memset(words + first + 1, value ? 0xff : 0, sizeof(uint64_t) * (last - first - 1));
+            words[last] = value ? words[last] | tail : words[last] & ~tail;
+        }
+        vbits->dirty = 1;
+        return VBITS_SUCCESS;
+    }
+    return VBITS_ERROR ^ VBITS_BITSET_404;
+}
+
+/* Sets the size of `varray` to `n` values, added values are zeroed */
+static int
+vbits_array_resize(struct void_array* varray, const unsigned long n)
+{
+    if (n > varray->size) {
+        unsigned long capacity = varray->capacity, doublings = 0;
+        /* an array without memory gets a capacity of 1 on the first doubling */
+        while (capacity < n) {
+            capacity = capacity ? capacity << 1 : 1;
+            doublings++;
+        }
+        varr_expand(varray, doublings);
+        /* a failed reallocation leaves the capacity unchanged */
+        if (varray->capacity < n) {
+            return VBITS_ERROR;
+        }
+        memset((unsigned char*)varr_data(varray) + varray->value_size * varray->size, 0,
+               varray->value_size * (n - varray->size));
+    }
+    varray->size = n;
+    return VBITS_SUCCESS;
+}
+
+/* Counts the set bits in front of every `VBITS_RANK_BITS` bits */
+static int
+vbits_build_ranks(struct void_bitset* vbits)
+{
+    const unsigned long n_words = vbits->words.size;
+    const unsigned long n_ranks = (n_words + WORDS_PER_RANK - 1) / WORDS_PER_RANK + 1;
+    unsigned long* ranks;
+    unsigned long count = 0;
+
+    if (vbits_array_resize(&vbits->ranks, n_ranks) != VBITS_SUCCESS) {
+        return VBITS_ERROR;
+    }
+    ranks = RANKS(vbits);
+    for (unsigned long r = 0; r + 1 < n_ranks; r++) {
+        const unsigned long first = r * WORDS_PER_RANK;
+        ranks[r] = count;
+        count += vbits_popcount(WORDS(vbits) + first,
+                                n_words - first < WORDS_PER_RANK ? n_words - first : WORDS_PER_RANK);
+    }
+    ranks[n_ranks - 1] = count;
+    vbits->dirty = 0;
+    return VBITS_SUCCESS;
+}
+
+/* Index of the set bit with rank `k` in `word`, which has more than `k` set bits */
+static inline unsigned
+vbits_select_word(uint64_t word, unsigned long k)
+{
+#ifdef VBITS_X86
+    if (HAS_BMI2()) {
+        return vbits_select_word_bmi2(word, k);
+    }
+#endif
+    while (k--) {
+        word &= word - 1;
+    }
+    return (unsigned)__builtin_ctzll(word);
+}
+
+int
+vbits_resize(struct void_bitset* vbits, const unsigned long n_bits)
+{
+    if (vbits) {
+        if (vbits_array_resize(&vbits->words, vbits_word_count(n_bits)) != VBITS_SUCCESS) {
+            return VBITS_ERROR;
+        }
+        /* keeps the bits past the end zero */
+        if (n_bits % 64) {
+            WORDS(vbits)[n_bits / 64] &= vbits_mask(0, n_bits % 64);
+        }
+        vbits->size = n_bits;
+        vbits->dirty = 1;
+        return VBITS_SUCCESS;
+    }
+    return VBITS_ERROR ^ VBITS_BITSET_404;
+}
+
+int
+vbits_set(struct void_bitset* vbits, const unsigned long idx)
+{
+    if (vbits) {
+        if (idx >= vbits->size) {
+            return VBITS_ERROR ^ VBITS_INDEX_OUT_OF_RANGE;
+        }
+        WORDS(vbits)[idx / 64] |= UINT64_C(1) << (idx % 64);
+        vbits->dirty = 1;
+        return VBITS_SUCCESS;
+    }
+    return VBITS_ERROR ^ VBITS_BITSET_404;
+}
+
+int
+vbits_clear(struct void_bitset* vbits, const unsigned long idx)
+{
+    if (vbits) {
+        if (idx >= vbits->size) {
+            return VBITS_ERROR ^ VBITS_INDEX_OUT_OF_RANGE;
+        }
+        WORDS(vbits)[idx / 64] &= ~(UINT64_C(1) << (idx % 64));
+        vbits->dirty = 1;
+        return VBITS_SUCCESS;
+    }
+    return VBITS_ERROR ^ VBITS_BITSET_404;
+}
+
+int
+vbits_test(const struct void_bitset* vbits, const unsigned long idx)
+{
+    if (idx < vbits->size) {
+        return (int)((WORDS(vbits)[idx / 64] >> (idx % 64)) & 1);
+    }
+    return 0;
+}
+
+int
+vbits_set_range(struct void_bitset* vbits, const unsigned long idx, const unsigned long n)
+{
+    return vbits_fill(vbits, idx, n, 1);
+}
+
+int
+vbits_clear_range(struct void_bitset* vbits, const unsigned long idx, const unsigned long n)
+{
+    return vbits_fill(vbits, idx, n, 0);
+}
+
+unsigned long
+vbits_count(const struct void_bitset* vbits)
+{
+    return vbits_popcount(WORDS(vbits), vbits->words.size);
+}
+
+int
+vbits_and(struct void_bitset* dst, const struct void_bitset* src)
+{
+    return vbits_op(dst, src, VBITS_OP_AND);
+}
+
+int
+vbits_or(struct void_bitset* dst, const struct void_bitset* src)
+{
+    return vbits_op(dst, src, VBITS_OP_OR);
+}
+
+int
+vbits_xor(struct void_bitset* dst, const struct void_bitset* src)
+{
+    return vbits_op(dst, src, VBITS_OP_XOR);
+}
+
+int
+vbits_andnot(struct void_bitset* dst, const struct void_bitset* src)
+{
+    return vbits_op(dst, src, VBITS_OP_ANDNOT);
+}
+
+unsigned long
+vbits_rank(struct void_bitset* vbits, const unsigned long idx)
+{
+    const unsigned long end = idx < vbits->size ? idx : vbits->size;
+    const unsigned long word = end / 64;
+    const unsigned long first = word / WORDS_PER_RANK * WORDS_PER_RANK;
+    unsigned long count;
+
+    if (vbits->dirty && vbits_build_ranks(vbits) != VBITS_SUCCESS) {
+        /* no memory for the directory, count from the start */
+        count = vbits_popcount(WORDS(vbits), word);
+    } else {
+        count = RANKS(vbits)[word / WORDS_PER_RANK] + vbits_popcount(WORDS(vbits) + first, word - first);
+    }
+    if (end % 64) {
+        count += (unsigned long)__builtin_popcountll(WORDS(vbits)[word] & vbits_mask(0, end % 64));
+    }
+    return count;
+}
+
+unsigned long
+vbits_select(struct void_bitset* vbits, const unsigned long k)
+{
+    const uint64_t* words = WORDS(vbits);
+    unsigned long low = 0, high, remaining, w;
+
+    if (vbits->dirty && vbits_build_ranks(vbits) != VBITS_SUCCESS) {
+        /* no memory for the directory, scan from the start */
+        remaining = k;
+        w = 0;
+    } else {
+        const unsigned long* ranks = RANKS(vbits);
+        high = vbits->ranks.size - 1;
+        if (k >= ranks[high]) {
+            return vbits->size;
+        }
+        /* last block with less than `k` + 1 bits in front of it */
+        while (high - low > 1) {
+            const unsigned long mid = low + (high - low) / 2;
+            if (ranks[mid] <= k) {
+                low = mid;
+            } else {
+                high = mid;
+            }
+        }
+        remaining = k - ranks[low];
+        w = low * WORDS_PER_RANK;
+    }
+    for (; w < vbits->words.size; w++) {
+        const unsigned long count = (unsigned long)__builtin_popcountll(words[w]);
+        if (remaining < count) {
+            return w * 64 + vbits_select_word(words[w], remaining);
+        }
+        remaining -= count;
+    }
+    return vbits->size;
+}
+
+unsigned long
+vbits_next_set(const struct void_bitset* vbits, const unsigned long idx)
+{
+    const uint64_t* words = WORDS(vbits);
+    unsigned long w = idx / 64;
+    uint64_t word;
+
+    if (idx >= vbits->size) {
+        return vbits->size;
+    }
+    word = words[w] & (~UINT64_C(0) << (idx % 64));
+    while (!word) {
+        if (++w >= vbits->words.size) {
+            return vbits->size;
+        }
+        word = words[w];
+    }
+    return w * 64 + (unsigned long)__builtin_ctzll(word);
+}
+
+int
+vbits_init(struct void_bitset* vbits, const unsigned long n_bits)
+{
+    if (vbits) {
+        const unsigned long n_words = vbits_word_count(n_bits);
+        varr_init(&vbits->words, n_words ? n_words : 1, sizeof(uint64_t), NULL);
+        varr_init(&vbits->ranks, n_words / WORDS_PER_RANK + 2, sizeof(unsigned long), NULL);
+        vbits->size = 0;
+        vbits->dirty = 1;
+        return vbits_resize(vbits, n_bits);
+    }
+    return VBITS_ERROR ^ VBITS_BITSET_404;
+}
+
+void
+vbits_free(void* vbits_ptr)
+{
+    struct void_bitset* vbits = (struct void_bitset*)vbits_ptr;
+    varr_free(&vbits->words);
+    varr_free(&vbits->ranks);
+    vbits->size = 0;
+    vbits->dirty = 0;
+}
@@ -0,0 +1,219 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#ifndef VB_VOID_BITSET_H
+#define VB_VOID_BITSET_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "void_array.h"
+
+/**
+ * Error Codes
+ */
+#define VBITS_SUCCESS               0
+#define VBITS_ERROR                 1
+#define VBITS_BITSET_404            2
+#define VBITS_INDEX_OUT_OF_RANGE    3
+#define VBITS_SIZE_MISMATCH         4
+
+/**
+ * Amount of bits counted by one entry of the rank directory
+ */
+#define VBITS_RANK_BITS             512
+
+/**
+ * Void Bitset Structure
+ * One bit per value, packed into the 64 bit words of a Void Array.
+ * Counting and bulk operations work on 256 bits at once on x86-64 CPUs
+ * with AVX2, which is detected at runtime, and one word at a time otherwise.
+ * Bits past `size` in the last word are always zero.
+ */
+struct void_bitset {
+    /** uint64_t words, bit `i` is bit `i % 64` of word `i / 64` */
+    struct void_array words;
+    /** amount of set bits in front of every `VBITS_RANK_BITS` bits, followed by the total */
+    struct void_array ranks;
+    /** amount of bits */
+    unsigned long size;
+    /** whether `ranks` is outdated */
+    int dirty;
+};
+
+/**
+ * Changes the amount of bits to `n_bits`, added bits are cleared.
+ *
+ * @param vbits Void Bitset to resize
+ * @param n_bits New amount of bits
+ * @return Error Code
+ */
+int
+vbits_resize(struct void_bitset* vbits, const unsigned long n_bits);
+
+/**
+ * Sets the bit at `idx`.
+ *
+ * @param vbits Void Bitset to set the bit in
+ * @param idx Index of the bit
+ * @return Error Code
+ */
+int
+vbits_set(struct void_bitset* vbits, const unsigned long idx);
+
+/**
+ * Clears the bit at `idx`.
+ *
+ * @param vbits Void Bitset to clear the bit in
+ * @param idx Index of the bit
+ * @return Error Code
+ */
+int
+vbits_clear(struct void_bitset* vbits, const unsigned long idx);
+
+/**
+ * Returns whether the bit at `idx` is set.
+ *
+ * @param vbits Void Bitset to test
+ * @param idx Index of the bit
+ * @return 1 if set, 0 if cleared or out of range
+ */
+int
+vbits_test(const struct void_bitset* vbits, const unsigned long idx);
+
+/**
+ * Sets the bits from `idx` to `idx + n`.
+ *
+ * @param vbits Void Bitset to set the bits in
+ * @param idx Index of the first bit
+ * @param n Amount of bits
+ * @return Error Code
+ */
+int
+vbits_set_range(struct void_bitset* vbits, const unsigned long idx, const unsigned long n);
+
+/**
+ * Clears the bits from `idx` to `idx + n`.
+ *
+ * @param vbits Void Bitset to clear the bits in
+ * @param idx Index of the first bit
+ * @param n Amount of bits
+ * @return Error Code
+ */
+int
+vbits_clear_range(struct void_bitset* vbits, const unsigned long idx, const unsigned long n);
+
+/**
+ * Returns the amount of set bits.
+ *
+ * @param vbits Void Bitset to count
+ * @return Amount of set bits
+ */
+unsigned long
+vbits_count(const struct void_bitset* vbits);
+
+/**
+ * `dst` becomes `dst & src`, both must have the same size.
+ *
+ * @param dst Void Bitset to store the result in
+ * @param src Second operand
+ * @return Error Code
+ */
+int
+vbits_and(struct void_bitset* dst, const struct void_bitset* src);
+
+/**
+ * `dst` becomes `dst | src`, both must have the same size.
+ *
+ * @param dst Void Bitset to store the result in
+ * @param src Second operand
+ * @return Error Code
+ */
+int
+vbits_or(struct void_bitset* dst, const struct void_bitset* src);
+
+/**
+ * `dst` becomes `dst ^ src`, both must have the same size.
+ *
+ * @param dst Void Bitset to store the result in
+ * @param src Second operand
+ * @return Error Code
+ */
+int
+vbits_xor(struct void_bitset* dst, const struct void_bitset* src);
+
+/**
+ * `dst` becomes `dst & ~src`, both must have the same size.
+ *
+ * @param dst Void Bitset to store the result in
+ * @param src Bits to clear in `dst`
+ * @return Error Code
+ */
+int
+vbits_andnot(struct void_bitset* dst, const struct void_bitset* src);
+
+/**
+ * Returns the amount of set bits in front of `idx` in O(1).
+ * Rebuilds the rank directory first if bits changed since the last query.
+ *
+ * @param vbits Void Bitset to query
+ * @param idx Index up to which set bits are counted (at most `vbits->size`)
+ * @return Amount of set bits in [0, `idx`)
+ */
+unsigned long
+vbits_rank(struct void_bitset* vbits, const unsigned long idx);
+
+/**
+ * Returns the index of the set bit with rank `k`, i.e. the (`k` + 1)th set bit,
+ * in O(log n). Rebuilds the rank directory first if bits changed since the last query.
+ *
+ * @param vbits Void Bitset to query
+ * @param k Amount of set bits in front of the searched one
+ * @return Index of the bit (`vbits->size` if less than `k` + 1 bits are set)
+ */
+unsigned long
+vbits_select(struct void_bitset* vbits, const unsigned long k);
+
+/**
+ * Returns the index of the first set bit at or after `idx`.
+ *
+ * @param vbits Void Bitset to scan
+ * @param idx Index to start at
+ * @return Index of the bit (`vbits->size` if there is none)
+ */
+unsigned long
+vbits_next_set(const struct void_bitset* vbits, const unsigned long idx);
+
+/**
+ * Initializes a Void Bitset with `n_bits` cleared bits.
+ *
+ * @param vbits Void Bitset to be initialized
+ * @param n_bits Amount of bits
+ * @return Error Code
+ */
+int
+vbits_init(struct void_bitset* vbits, const unsigned long n_bits);
+
+/**
+ * Assumes `vbits_ptr` is of type `struct void_bitset*`.
+ * Frees all allocated data of the Bitset.
+ *
+ * @param vbits_ptr Void Bitset of which the content is to be freed
+ */
+void
+vbits_free(void* vbits_ptr);
+
+#endif /* VB_VOID_BITSET_H */
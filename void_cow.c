@@ -0,0 +1,233 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#include <stddef.h>
+#include <string.h>
+
+#include "void_cow.h"
+#include "void_telemetry.h"
+
+#define CHUNKS(version) ((struct vcow_chunk**)varr_data(&(version)->chunks))
+#define CHUNK_BYTES(version) ((version)->value_size * (version)->chunk_values)
+
+static struct vcow_chunk*
+vcow_chunk_alloc(const struct void_allocator* allocator, size_t bytes)
+{
+    struct vcow_chunk* chunk = (struct vcow_chunk*)valloc_alloc(allocator, sizeof(struct vcow_chunk) + bytes);
+    if (chunk) {
+        VTELEM_ALLOC(VTELEM_COW, bytes);
+        chunk->refs = 1;
+    }
+    return chunk;
+}
+
+static void
+vcow_chunk_release(const struct void_allocator* allocator, struct vcow_chunk* chunk, size_t bytes)
+{
+    if (__atomic_sub_fetch(&chunk->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        VTELEM_FREE(VTELEM_COW, bytes);
+        valloc_free(allocator, chunk, sizeof(struct vcow_chunk) + bytes);
+    }
+}
+
+static struct vcow_version*
+vcow_version_alloc(const struct void_allocator* allocator, size_t value_size, size_t chunk_values, unsigned long chunk_capacity)
+{
+    struct vcow_version* version = (struct vcow_version*)valloc_alloc(allocator, sizeof(struct vcow_version));
+    if (version) {
+        version->refs = 1;
+        version->value_size = value_size;
+        version->chunk_values = chunk_values;
+        version->allocator = allocator;
+        if (varr_init_alloc(&version->chunks, chunk_capacity ? chunk_capacity : 1, sizeof(struct vcow_chunk*), NULL, allocator) != VARR_SUCCESS) {
+            valloc_free(allocator, version, sizeof(struct vcow_version));
+            return NULL;
+        }
+    }
+    return version;
+}
+
+/* Returns the head version once no snapshot references it, sharing all chunks with the old one */
+static struct vcow_version*
+vcow_own_version(struct void_cow* vcow)
+{
+    struct vcow_version* head = vcow->head;
+    struct vcow_version* copy;
+
+    if (__atomic_load_n(&head->refs, __ATOMIC_ACQUIRE) == 1) {
+        return head;
+    }
+    copy = vcow_version_alloc(head->allocator, head->value_size, head->chunk_values, head->chunks.size);
+    if (!copy) {
+        return NULL;
+    }
+    varr_add(&copy->chunks, varr_data(&head->chunks), head->chunks.size);
+    for (unsigned long i = 0; i < copy->chunks.size; i++) {
+        __atomic_add_fetch(&CHUNKS(copy)[i]->refs, 1, __ATOMIC_RELAXED);
+    }
+    copy->size = head->size;
+    vcow->head = copy;
+    vcow_release(head);
+    return copy;
+}
+
+/* Returns chunk `chunk_idx` of the head version once no other version references it */
+static struct vcow_chunk*
+vcow_own_chunk(struct void_cow* vcow, size_t chunk_idx)
+{
+    struct vcow_version* head = vcow_own_version(vcow);
+    struct vcow_chunk* chunk;
+    struct vcow_chunk* copy;
+
+    if (!head) {
+        return NULL;
+    }
+    chunk = CHUNKS(head)[chunk_idx];
+    if (__atomic_load_n(&chunk->refs, __ATOMIC_ACQUIRE) == 1) {
+        return chunk;
+    }
+    if (!(copy = vcow_chunk_alloc(head->allocator, CHUNK_BYTES(head)))) {
+        return NULL;
+    }
+    memcpy(copy->bytes, chunk->bytes, CHUNK_BYTES(head));
+    VTELEM_MOVE(VTELEM_COW, CHUNK_BYTES(head));
+    CHUNKS(head)[chunk_idx] = copy;
+    vcow_chunk_release(head->allocator, chunk, CHUNK_BYTES(head));
+    return copy;
+}
+
+int
+vcow_add(struct void_cow* vcow, const void* data, size_t n)
+{
+    if (vcow) {
+        struct vcow_version* head = vcow_own_version(vcow);
+        const unsigned char* bytes = (const unsigned char*)data;
+
+        if (!head) {
+            return VCOW_ERROR ^ VCOW_NO_MEMORY;
+        }
+        while (n) {
+            size_t offset = head->size % head->chunk_values;
+            size_t count = head->chunk_values - offset < n ? head->chunk_values - offset : n;
+            struct vcow_chunk* chunk;
+
+            if (offset == 0) {
+                if (!(chunk = vcow_chunk_alloc(head->allocator, CHUNK_BYTES(head)))) {
+                    return VCOW_ERROR ^ VCOW_NO_MEMORY;
+                }
+                if (varr_add(&head->chunks, &chunk, 1) != VARR_SUCCESS) {
+                    vcow_chunk_release(head->allocator, chunk, CHUNK_BYTES(head));
+                    return VCOW_ERROR ^ VCOW_NO_MEMORY;
+                }
+            } else if (!(chunk = vcow_own_chunk(vcow, head->size / head->chunk_values))) {
+                return VCOW_ERROR ^ VCOW_NO_MEMORY;
+            }
+            memcpy(chunk->bytes + head->value_size * offset, bytes, head->value_size * count);
+            head->size += count;
+            bytes += head->value_size * count;
+            n -= count;
+        }
+        return VCOW_SUCCESS;
+    }
+    return VCOW_ERROR ^ VCOW_ARRAY_404;
+}
+
+void*
+vcow_write(struct void_cow* vcow, size_t idx)
+{
+    if (idx < vcow->head->size) {
+        struct vcow_chunk* chunk = vcow_own_chunk(vcow, idx / vcow->head->chunk_values);
+        if (chunk) {
+            return chunk->bytes + vcow->head->value_size * (idx % vcow->head->chunk_values);
+        }
+    }
+    return NULL;
+}
+
+int
+vcow_set(struct void_cow* vcow, size_t idx, const void* data)
+{
+    if (vcow) {
+        void* value;
+        if (idx >= vcow->head->size) {
+            return VCOW_ERROR ^ VCOW_INDEX_OUT_OF_RANGE;
+        }
+        if (!(value = vcow_write(vcow, idx))) {
+            return VCOW_ERROR ^ VCOW_NO_MEMORY;
+        }
+        memcpy(value, data, vcow->head->value_size);
+        return VCOW_SUCCESS;
+    }
+    return VCOW_ERROR ^ VCOW_ARRAY_404;
+}
+
+const struct vcow_version*
+vcow_snapshot(struct void_cow* vcow)
+{
+    return vcow_retain(vcow->head);
+}
+
+const struct vcow_version*
+vcow_retain(const struct vcow_version* snapshot)
+{
+    __atomic_add_fetch(&((struct vcow_version*)snapshot)->refs, 1, __ATOMIC_RELAXED);
+    return snapshot;
+}
+
+void
+vcow_release(const struct vcow_version* snapshot)
+{
+    struct vcow_version* version = (struct vcow_version*)snapshot;
+    if (version && __atomic_sub_fetch(&version->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        for (unsigned long i = 0; i < version->chunks.size; i++) {
+            vcow_chunk_release(version->allocator, CHUNKS(version)[i], CHUNK_BYTES(version));
+        }
+        varr_free(&version->chunks);
+        valloc_free(version->allocator, version, sizeof(struct vcow_version));
+    }
+}
+
+const void*
+vcow_get(const struct vcow_version* version, size_t idx)
+{
+    if (idx < version->size) {
+        return CHUNKS(version)[idx / version->chunk_values]->bytes + version->value_size * (idx % version->chunk_values);
+    }
+    return NULL;
+}
+
+int
+vcow_init(struct void_cow* vcow, size_t chunk_values, size_t value_size)
+{
+    if (vcow) {
+        if (!chunk_values || !value_size) {
+            return VCOW_ERROR;
+        }
+        if (!(vcow->head = vcow_version_alloc(valloc_default(), value_size, chunk_values, 1))) {
+            return VCOW_ERROR ^ VCOW_NO_MEMORY;
+        }
+        return VCOW_SUCCESS;
+    }
+    return VCOW_ERROR ^ VCOW_ARRAY_404;
+}
+
+void
+vcow_free(void* vcow_ptr)
+{
+    struct void_cow* vcow = (struct void_cow*)vcow_ptr;
+    vcow_release(vcow->head);
+    vcow->head = NULL;
+}
@@ -0,0 +1,173 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#ifndef VC_VOID_COW_H
+#define VC_VOID_COW_H
+
+#include <stdlib.h>
+
+#include "void_array.h"
+
+/**
+ * Error Codes
+ */
+#define VCOW_SUCCESS                0
+#define VCOW_ERROR                  1
+#define VCOW_ARRAY_404              2
+#define VCOW_INDEX_OUT_OF_RANGE     3
+#define VCOW_NO_MEMORY              4
+
+/**
+ * Chunk Structure
+ * Fixed amount of values shared by every version referencing it.
+ */
+struct vcow_chunk {
+    /** amount of versions referencing the chunk */
+    size_t refs;
+    /** `chunk_values` values */
+    unsigned char bytes[];
+};
+
+/**
+ * Version Structure
+ * Immutable once a snapshot of it was taken.
+ */
+struct vcow_version {
+    /** amount of snapshots plus the owning Void COW Array */
+    size_t refs;
+    /** amount of values */
+    size_t size;
+    /** size of a value in bytes */
+    size_t value_size;
+    /** amount of values per chunk */
+    size_t chunk_values;
+    /** all chunks of type `struct vcow_chunk*` */
+    struct void_array chunks;
+    /** allocator of the version, its chunks and `chunks` */
+    const struct void_allocator* allocator;
+};
+
+/**
+ * Void COW Array Structure
+ * Values are stored in reference counted chunks, so snapshots share
+ * all chunks the writer didn't touch since the snapshot was taken.
+ * Only the owning thread may modify the array or take snapshots,
+ * snapshots may be read and released by any thread without locking.
+ */
+struct void_cow {
+    /** current version, only modified in place while no snapshot references it */
+    struct vcow_version* head;
+};
+
+/**
+ * Appends `n` values of `data`.
+ * Copies the last chunk if it is shared with a snapshot.
+ *
+ * @param vcow Void COW Array to append to
+ * @param data Array of values to be copied
+ * @param n Amount of values
+ * @return Error Code
+ */
+int
+vcow_add(struct void_cow* vcow, const void* data, size_t n);
+
+/**
+ * Returns a writable pointer to the value at `idx`.
+ * The chunk of the value is copied first if it is shared with a snapshot.
+ * The pointer is invalidated by the next snapshot.
+ *
+ * @param vcow Void COW Array to write to
+ * @param idx Index of the value
+ * @return Pointer to the value (NULL if idx out of range or out of memory)
+ */
+void*
+vcow_write(struct void_cow* vcow, size_t idx);
+
+/**
+ * Copies `data` into the value at `idx`.
+ *
+ * @param vcow Void COW Array to write to
+ * @param idx Index of the value
+ * @param data Data of size `value_size` to be copied
+ * @return Error Code
+ */
+int
+vcow_set(struct void_cow* vcow, size_t idx, const void* data);
+
+/**
+ * Returns a snapshot of the current values in O(1).
+ * It has to be released with `vcow_release`.
+ * Hand it to other threads before releasing it or retain it for each of them.
+ *
+ * @param vcow Void COW Array to take the snapshot of
+ * @return Snapshot
+ */
+const struct vcow_version*
+vcow_snapshot(struct void_cow* vcow);
+
+/**
+ * Adds a reference to `snapshot`, which has to be released separately.
+ *
+ * @param snapshot Snapshot still referenced by the caller
+ * @return `snapshot`
+ */
+const struct vcow_version*
+vcow_retain(const struct vcow_version* snapshot);
+
+/**
+ * Drops a reference to `snapshot`, the last one frees it
+ * along with all chunks no other version references.
+ * Thread-safe.
+ *
+ * @param snapshot Snapshot to be released
+ */
+void
+vcow_release(const struct vcow_version* snapshot);
+
+/**
+ * Returns pointer to the value at `idx` of a snapshot
+ * or the current version `vcow->head`.
+ *
+ * @param version Snapshot or current version to read from
+ * @param idx Index of the value
+ * @return Pointer to the value (NULL if idx out of range)
+ */
+const void*
+vcow_get(const struct vcow_version* version, size_t idx);
+
+/**
+ * Initializes a Void COW Array.
+ * All memory comes from the default allocator at the time of the call,
+ * which has to be thread-safe if snapshots are released by other threads.
+ *
+ * @param vcow Void COW Array to be initialized
+ * @param chunk_values Amount of values copied at once on a shared write
+ * @param value_size Size of Values to be saved (in Bytes)
+ * @return Error Code
+ */
+int
+vcow_init(struct void_cow* vcow, size_t chunk_values, size_t value_size);
+
+/**
+ * Assumes `vcow_ptr` is of type `struct void_cow*`.
+ * Releases the current version, snapshots stay valid until released.
+ *
+ * @param vcow_ptr Void COW Array of which the content is to be freed
+ */
+void
+vcow_free(void* vcow_ptr);
+
+#endif /* VC_VOID_COW_H */
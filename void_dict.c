@@ -14,54 +14,39 @@
     License Version 2.1 along with this library; if not, 
     write to <andre.schneider@outlook.at>.
 */
+#define VD_VOID_DICT_C
 #include "void_dict.h"
+#include "void_telemetry.h"
 
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
 
-size_t 
-vdict_hash(const struct void_dict* vdict, const void* key) 
+static inline void 
+vdict_destroy(struct void_dict* vdict, size_t hash, size_t n) 
 {
-    const unsigned char* data = (const unsigned char*)key;
-    unsigned char byte;
-    size_t hash = 5381;
-
-    for (size_t i = 0; i < vdict->key_size; i++) {
-        if ((byte = *(data + i))) {
-            hash = ((hash << 5) + hash) ^ byte;
+    if (vdict->range_free_fn) {
+        vdict->range_free_fn((unsigned char*)vdict_values(vdict) + vdict->value_size * hash, n, vdict->value_size);
+    } else if (vdict->value_free_fn) {
+        for (size_t i = 0; i < n; i++) {
+            vdict->value_free_fn((unsigned char*)vdict_values(vdict) + vdict->value_size * (hash + i));
         }
     }
-
-    return hash % vdict->hash_pool;
 }
 
-size_t* 
-vdict_hash_bsearch(const struct void_dict* vdict, const size_t hash, size_t* idx) 
+static inline void 
+vdict_destroy_all(struct void_dict* vdict) 
 {
-    size_t* needle = NULL;
-    size_t needle_idx = 0;
-    if (vdict->size) {
-        size_t f_idx = 0, l_idx = vdict->size - 1;
-        while (f_idx <= l_idx) {
-            needle_idx = (f_idx + l_idx) >> 1;
-            if (vdict->hashes[needle_idx] < hash && needle_idx != 0) {
-                f_idx = needle_idx + 1;
-            } else if (vdict->hashes[needle_idx] > hash && needle_idx != 0) {
-                l_idx = needle_idx - 1;
-            } else {
-                break;
+    if (vdict->range_free_fn || vdict->value_free_fn) {
+        /* Hashes are sorted, so consecutive hashes form contiguous ranges of values */
+        size_t first = 0;
+        for (size_t hash_idx = 1; hash_idx <= vdict->size; hash_idx++) {
+            if (hash_idx == vdict->size || vdict_hashes(vdict)[hash_idx] != vdict_hashes(vdict)[hash_idx - 1] + 1) {
+                vdict_destroy(vdict, vdict_hashes(vdict)[first], hash_idx - first);
+                first = hash_idx;
             }
         }
-
-        if (f_idx <= l_idx && vdict->hashes[needle_idx] == hash) {
-            needle = vdict->hashes + needle_idx;
-        }
-    }
-    if (idx != NULL) {
-        *idx = needle_idx;
     }
-    return needle;
 }
 
 int 
@@ -69,7 +54,7 @@ vdict_add_pair(struct void_dict* vdict, void* key, void* value)
 {
     if (vdict->size == vdict->hash_pool) {
         return VDICT_ERROR ^ VDICT_FULL;
-    } else if (memcmp(key, vdict->key_zero_field, vdict->key_size) == 0) {
+    } else if (memcmp(key, vdict_zero_key(vdict), vdict->key_size) == 0) {
         return VDICT_ERROR ^ VDICT_ZERO_KEY;
     }
     size_t hash = vdict_hash(vdict, key);
@@ -77,47 +62,22 @@ vdict_add_pair(struct void_dict* vdict, void* key, void* value)
     while (vdict_hash_bsearch(vdict, hash, &needle_idx)) {
         hash = (hash + 1) % vdict->hash_pool;
     }
-    memcpy((unsigned char*)vdict->key_bytes + hash * vdict->key_size, key, vdict->key_size);
-    memcpy((unsigned char*)vdict->value_bytes + hash * vdict->value_size, value, vdict->value_size);
-    if (vdict->size && vdict->hashes[needle_idx] < hash) needle_idx = (needle_idx + 1) % vdict->hash_pool;
-    memmove(vdict->hashes + needle_idx + 1, vdict->hashes + needle_idx,
+    memcpy((unsigned char*)vdict_keys(vdict) + hash * vdict->key_size, key, vdict->key_size);
+    memcpy((unsigned char*)vdict_values(vdict) + hash * vdict->value_size, value, vdict->value_size);
+    if (vdict->size && vdict_hashes(vdict)[needle_idx] < hash) needle_idx = (needle_idx + 1) % vdict->hash_pool;
+    memmove(vdict_hashes(vdict) + needle_idx + 1, vdict_hashes(vdict) + needle_idx,
             sizeof(size_t) * (vdict->size - needle_idx));
-    vdict->hashes[needle_idx] = hash;
+    VTELEM_MOVE(VTELEM_DICT, sizeof(size_t) * (vdict->size - needle_idx));
+    vdict_hashes(vdict)[needle_idx] = hash;
     vdict->size++;
     return VDICT_SUCCESS;
 }
 
-void* 
-vdict_get_value(const struct void_dict* vdict, const void* key) 
-{
-    size_t hash = vdict_hash(vdict, key);
-    if (vdict->size && vdict_hash_bsearch(vdict, hash, NULL)) {
-        unsigned char found = 0;
-        size_t checked = 0;
-        while (!found && checked < vdict->size) {
-            if (memcmp((unsigned char*)vdict->key_bytes + vdict->key_size * hash, vdict->key_zero_field, vdict->key_size) == 0) {
-                break;
-            } else if (memcmp((unsigned char*)vdict->key_bytes + vdict->key_size * hash, key, vdict->key_size) == 0) {
-                found = 1;
-                break;
-            } else {
-                hash = (hash + 1) % vdict->hash_pool;
-                checked++;
-            }
-        }
-
-        if (found) {
-            return (unsigned char*)vdict->value_bytes + vdict->value_size * hash;
-        }
-    }
-    return NULL;
-}
-
 void* 
 vdict_get_keys(const struct void_dict* vdict, void* key_array) 
 {
     for (size_t i = 0; i < vdict->size; i++) {
-        memcpy((unsigned char*)key_array + (vdict->key_size * i), (unsigned char*)vdict->key_bytes + (vdict->key_size * vdict->hashes[i]), vdict->key_size);
+        memcpy((unsigned char*)key_array + (vdict->key_size * i), (unsigned char*)vdict_keys(vdict) + (vdict->key_size * vdict_hashes(vdict)[i]), vdict->key_size);
     }
     return key_array;
 }
@@ -127,18 +87,17 @@ vdict_del_pair(struct void_dict* vdict, const void* key)
 {
     unsigned char* value_ptr = (unsigned char*)vdict_get_value(vdict, key);
     if (value_ptr) {
-        size_t hash = (value_ptr + vdict->value_size - (unsigned char*)vdict->value_bytes) / vdict->key_size;
-        memset((unsigned char*)vdict->key_bytes + vdict->key_size * hash, 0, vdict->key_size);
-        if (vdict->value_free_fn) {
-            vdict->value_free_fn((unsigned char*)vdict->value_bytes + vdict->value_size * hash);
-        }
-        memset((unsigned char*)vdict->value_bytes + vdict->value_size * hash, 0, vdict->value_size);
+        size_t hash = (value_ptr - vdict_values(vdict)) / vdict->value_size;
+        memset((unsigned char*)vdict_keys(vdict) + vdict->key_size * hash, 0, vdict->key_size);
+        vdict_destroy(vdict, hash, 1);
+        memset((unsigned char*)vdict_values(vdict) + vdict->value_size * hash, 0, vdict->value_size);
         size_t hash_idx;
         size_t* hash_ptr = vdict_hash_bsearch(vdict, hash, &hash_idx);
         memmove(hash_ptr, hash_ptr + 1,
-                sizeof(size_t) * (vdict->size - hash_idx));
-        memset(vdict->hashes + vdict->size, 0, sizeof(size_t));
+                sizeof(size_t) * (vdict->size - hash_idx - 1));
+        VTELEM_MOVE(VTELEM_DICT, sizeof(size_t) * (vdict->size - hash_idx - 1));
         vdict->size--;
+        memset(vdict_hashes(vdict) + vdict->size, 0, sizeof(size_t));
         return VDICT_SUCCESS;
     } else {
         return VDICT_ERROR ^ VDICT_KEY_404;
@@ -149,33 +108,67 @@ int
 vdict_clear(struct void_dict* vdict) 
 {
     if (vdict) {
-        memset(vdict->key_bytes, 0, vdict->key_size * vdict->hash_pool);
-        if (vdict->value_free_fn) {
-            for (size_t hash_idx = 0; hash_idx < vdict->size; hash_idx++) {
-                vdict->value_free_fn((unsigned char*)vdict->value_bytes + vdict->value_size * vdict->hashes[hash_idx]);
-            }
-        }
-        memset(vdict->value_bytes, 0, vdict->value_size * vdict->hash_pool);
-        memset(vdict->hashes, 0, sizeof(size_t) * vdict->size);
+        memset(vdict_keys(vdict), 0, vdict->key_size * vdict->hash_pool);
+        vdict_destroy_all(vdict);
+        memset(vdict_values(vdict), 0, vdict->value_size * vdict->hash_pool);
+        memset(vdict_hashes(vdict), 0, sizeof(size_t) * vdict->size);
         vdict->size = 0;
         return VDICT_SUCCESS;
     }
     return VDICT_ERROR ^ VDICT_DICT_404;
 }
 
+void 
+vdict_set_range_free_fn(struct void_dict* vdict, void(*range_free_fn)(void*, size_t, size_t)) 
+{
+    vdict->range_free_fn = range_free_fn;
+}
+
 int 
 vdict_init(struct void_dict* vdict, size_t hash_pool, size_t key_size, size_t value_size, void(*value_free_fn)(void*)) 
+{
+    return vdict_init_alloc(vdict, hash_pool, key_size, value_size, value_free_fn, NULL);
+}
+
+int 
+vdict_init_alloc(struct void_dict* vdict, size_t hash_pool, size_t key_size, size_t value_size, void(*value_free_fn)(void*), const struct void_allocator* allocator) 
 {
     if (vdict) {
-        vdict->key_bytes = calloc(key_size, hash_pool);
-        vdict->key_zero_field = calloc(key_size, hash_pool);
-        vdict->value_bytes = calloc(value_size, hash_pool);
-        vdict->hashes = (size_t*)calloc(sizeof(size_t), hash_pool);
+        vdict->allocator = allocator ? allocator : valloc_default();
         vdict->size = 0;
         vdict->key_size = key_size;
         vdict->value_size = value_size;
         vdict->hash_pool = hash_pool;
+#if VDICT_INLINE_BYTES > 0
+        vdict->is_inline = !allocator && (sizeof(size_t) + value_size + key_size) * hash_pool + key_size <= VDICT_INLINE_BYTES;
+        if (vdict->is_inline) {
+            memset(vdict->inline_bytes.bytes, 0, VDICT_INLINE_BYTES);
+            vdict->hashes = vdict_hashes(vdict);
+            vdict->value_bytes = vdict_values(vdict);
+            vdict->key_bytes = vdict_keys(vdict);
+            vdict->key_zero_field = vdict_zero_key(vdict);
+        } else
+#endif
+        {
+            vdict->key_bytes = valloc_alloc(vdict->allocator, key_size * hash_pool);
+            vdict->key_zero_field = valloc_alloc(vdict->allocator, key_size);
+            vdict->value_bytes = valloc_alloc(vdict->allocator, value_size * hash_pool);
+            vdict->hashes = (size_t*)valloc_alloc(vdict->allocator, sizeof(size_t) * hash_pool);
+            if (vdict->key_bytes) {
+                VTELEM_ALLOC(VTELEM_DICT, key_size * hash_pool);
+            }
+            if (vdict->key_zero_field) {
+                VTELEM_ALLOC(VTELEM_DICT, key_size);
+            }
+            if (vdict->value_bytes) {
+                VTELEM_ALLOC(VTELEM_DICT, value_size * hash_pool);
+            }
+            if (vdict->hashes) {
+                VTELEM_ALLOC(VTELEM_DICT, sizeof(size_t) * hash_pool);
+            }
+        }
         vdict->value_free_fn = value_free_fn;
+        vdict->range_free_fn = NULL;
         return VDICT_SUCCESS;
     }
     return VDICT_ERROR ^ VDICT_DICT_404;
@@ -185,15 +178,28 @@ void
 vdict_free(void* vdict_ptr) 
 {
     struct void_dict* vdict = (struct void_dict*)vdict_ptr;
-    if (vdict->value_free_fn) {
-        for (size_t hash_idx = 0; hash_idx < vdict->size; hash_idx++) {
-            vdict->value_free_fn((unsigned char*)vdict->value_bytes + vdict->value_size * vdict->hashes[hash_idx]);
+    vdict_destroy_all(vdict);
+#if VDICT_INLINE_BYTES > 0
+    if (!vdict->is_inline)
+#endif
+    {
+        valloc_free(vdict->allocator, vdict->hashes, sizeof(size_t) * vdict->hash_pool);
+        valloc_free(vdict->allocator, vdict->value_bytes, vdict->value_size * vdict->hash_pool);
+        valloc_free(vdict->allocator, (void*)vdict->key_zero_field, vdict->key_size);
+        valloc_free(vdict->allocator, vdict->key_bytes, vdict->key_size * vdict->hash_pool);
+        if (vdict->hashes) {
+            VTELEM_FREE(VTELEM_DICT, sizeof(size_t) * vdict->hash_pool);
+        }
+        if (vdict->value_bytes) {
+            VTELEM_FREE(VTELEM_DICT, vdict->value_size * vdict->hash_pool);
+        }
+        if (vdict->key_zero_field) {
+            VTELEM_FREE(VTELEM_DICT, vdict->key_size);
+        }
+        if (vdict->key_bytes) {
+            VTELEM_FREE(VTELEM_DICT, vdict->key_size * vdict->hash_pool);
         }
     }
-    free(vdict->key_bytes);
-    free((void*)vdict->key_zero_field);
-    free(vdict->value_bytes);
-    free(vdict->hashes);
     vdict->key_bytes = NULL;
     vdict->key_zero_field = NULL;
     vdict->value_bytes = NULL;
@@ -201,6 +207,11 @@ vdict_free(void* vdict_ptr)
     vdict->hash_pool = 0;
     vdict->size = 0;
     vdict->value_free_fn = NULL;
+    vdict->range_free_fn = NULL;
     vdict->value_size = 0;
     vdict->key_size = 0;
+    vdict->allocator = NULL;
+#if VDICT_INLINE_BYTES > 0
+    vdict->is_inline = 0;
+#endif
 }
@@ -21,6 +21,8 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "void_alloc.h"
+
 /**
  * Error Codes
  */
@@ -31,6 +33,26 @@
 #define VDICT_KEY_404              4
 #define VDICT_DICT_404             5
 
+/**
+ * Amount of bytes stored inside the structure itself, small dicts whose
+ * hashes, values and keys fit are not allocated on the heap.
+ * Off (0) unless defined at compile time, inline dicts must not be copied.
+ */
+#ifndef VDICT_INLINE_BYTES
+#define VDICT_INLINE_BYTES         0
+#endif
+
+/**
+ * Defining `VOID_HEADER_ONLY` turns hashing and lookups of the Void Dict
+ * into `static inline` functions of this header, so compilers can inline
+ * them into every caller. All other functions stay in void_dict.c.
+ */
+#ifdef VOID_HEADER_ONLY
+#define VDICT_HOT                  static inline
+#else
+#define VDICT_HOT
+#endif
+
 
 /**
  * Void Dict Structure
@@ -55,6 +77,21 @@ struct void_dict {
     size_t hash_pool;
     /** free function for recursive freeing on each value */
     void(*value_free_fn)(void*);
+    /** free function for batched freeing of `n` values from `base` every `stride` bytes */
+    void(*range_free_fn)(void*, size_t, size_t);
+    /** allocator of all byte arrays */
+    const struct void_allocator* allocator;
+#if VDICT_INLINE_BYTES > 0
+    /** whether all byte arrays are stored in `inline_bytes` */
+    int is_inline;
+    /** small buffer holding hashes, values, keys and the zero key in this order */
+    union {
+        void* align_ptr;
+        double align_double;
+        unsigned long long align_ull;
+        unsigned char bytes[VDICT_INLINE_BYTES];
+    } inline_bytes;
+#endif
 };
 
 /**
@@ -64,7 +101,7 @@ struct void_dict {
  * @param key Key to build hash of
  * @return Hash in Hash-Pool
  */
-size_t 
+VDICT_HOT size_t 
 vdict_hash(const struct void_dict* vdict, const void* key);
 
 /**
@@ -75,7 +112,7 @@ vdict_hash(const struct void_dict* vdict, const void* key);
  * @param idx Index of found Hash or last searched index
  * @return Pointer to found hash or NULL
  */
-size_t* 
+VDICT_HOT size_t* 
 vdict_hash_bsearch(const struct void_dict* vdict, const size_t hash, size_t* idx);
 
 /**
@@ -96,7 +133,7 @@ vdict_add_pair(struct void_dict* vdict, void* key, void* value);
  * @param key Key to get Value with
  * @return Pointer to Value (NULL if idx out of range)
  */
-void* 
+VDICT_HOT void* 
 vdict_get_value(const struct void_dict* vdict, const void* key);
 
 /**
@@ -129,8 +166,19 @@ vdict_del_pair(struct void_dict* vdict, const void* key);
 int 
 vdict_clear(struct void_dict* vdict);
 
+/**
+ * Sets a range free function which replaces `value_free_fn`.
+ * Values of adjacent hashes are passed as one range, see `varr_set_range_free_fn`.
+ *
+ * @param vdict Void Dict to set the range free function of
+ * @param range_free_fn Function to be called on ranges of values (Nullable)
+ */
+void 
+vdict_set_range_free_fn(struct void_dict* vdict, void(*range_free_fn)(void*, size_t, size_t));
+
 /**
  * Initializes a Void Dictionary.
+ * Dictionaries small enough for `VDICT_INLINE_BYTES` are stored inside the structure.
  *
  * @param dict Void Dictionary to be initialized
  * @param hash_pool Amount of Key-Value Pairs that can be stored
@@ -142,6 +190,22 @@ vdict_clear(struct void_dict* vdict);
 int 
 vdict_init(struct void_dict* vdict, size_t hash_pool, size_t key_size, size_t value_size, void(*value_free_fn)(void*));
 
+/**
+ * Initializes a Void Dictionary whose memory is managed
+ * by `allocator` instead of the default allocator.
+ * Dictionaries are only stored inside the structure if `allocator` is NULL.
+ *
+ * @param dict Void Dictionary to be initialized
+ * @param hash_pool Amount of Key-Value Pairs that can be stored
+ * @param key_size Size of Keys in Bytes
+ * @param value_size Size of Values in Bytes
+ * @param value_free_fn Function to be called when freeing special datatypes (Nullable)
+ * @param allocator Allocator of the Void Dictionary (NULL for the default allocator)
+ * @return Error Code
+ */
+int 
+vdict_init_alloc(struct void_dict* vdict, size_t hash_pool, size_t key_size, size_t value_size, void(*value_free_fn)(void*), const struct void_allocator* allocator);
+
 /**
  * Frees Content of Void Dict.
  * Calls vdict->value_free_fn on values if available.
@@ -151,4 +215,121 @@ vdict_init(struct void_dict* vdict, size_t hash_pool, size_t key_size, size_t va
 void 
 vdict_free(void* vdict_ptr);
 
+#if defined(VOID_HEADER_ONLY) || defined(VD_VOID_DICT_C)
+/* Byte arrays are located through these, as small buffer pointers break once the structure is copied */
+static inline size_t* 
+vdict_hashes(const struct void_dict* vdict) 
+{
+#if VDICT_INLINE_BYTES > 0
+    if (vdict->is_inline) {
+        return (size_t*)vdict->inline_bytes.bytes;
+    }
+#endif
+    return vdict->hashes;
+}
+
+static inline unsigned char* 
+vdict_values(const struct void_dict* vdict) 
+{
+#if VDICT_INLINE_BYTES > 0
+    if (vdict->is_inline) {
+        return (unsigned char*)vdict->inline_bytes.bytes + sizeof(size_t) * vdict->hash_pool;
+    }
+#endif
+    return (unsigned char*)vdict->value_bytes;
+}
+
+static inline unsigned char* 
+vdict_keys(const struct void_dict* vdict) 
+{
+#if VDICT_INLINE_BYTES > 0
+    if (vdict->is_inline) {
+        return (unsigned char*)vdict->inline_bytes.bytes + (sizeof(size_t) + vdict->value_size) * vdict->hash_pool;
+    }
+#endif
+    return (unsigned char*)vdict->key_bytes;
+}
+
+static inline const void* 
+vdict_zero_key(const struct void_dict* vdict) 
+{
+#if VDICT_INLINE_BYTES > 0
+    if (vdict->is_inline) {
+        return vdict_keys(vdict) + vdict->key_size * vdict->hash_pool;
+    }
+#endif
+    return vdict->key_zero_field;
+}
+
+VDICT_HOT size_t 
+vdict_hash(const struct void_dict* vdict, const void* key) 
+{
+    const unsigned char* data = (const unsigned char*)key;
+    unsigned char byte;
+    size_t hash = 5381;
+
+    for (size_t i = 0; i < vdict->key_size; i++) {
+        if ((byte = *(data + i))) {
+            hash = ((hash << 5) + hash) ^ byte;
+        }
+    }
+
+    return hash % vdict->hash_pool;
+}
+
+VDICT_HOT size_t* 
+vdict_hash_bsearch(const struct void_dict* vdict, const size_t hash, size_t* idx) 
+{
+    size_t* needle = NULL;
+    size_t needle_idx = 0;
+    if (vdict->size) {
+        size_t f_idx = 0, l_idx = vdict->size - 1;
+        while (f_idx <= l_idx) {
+            needle_idx = (f_idx + l_idx) >> 1;
+            if (vdict_hashes(vdict)[needle_idx] < hash && needle_idx != 0) {
+                f_idx = needle_idx + 1;
+            } else if (vdict_hashes(vdict)[needle_idx] > hash && needle_idx != 0) {
+                l_idx = needle_idx - 1;
+            } else {
+                break;
+            }
+        }
+
+        if (f_idx <= l_idx && vdict_hashes(vdict)[needle_idx] == hash) {
+            needle = vdict_hashes(vdict) + needle_idx;
+        }
+    }
+    if (idx != NULL) {
+        *idx = needle_idx;
+    }
+    return needle;
+}
+
+VDICT_HOT void* 
+vdict_get_value(const struct void_dict* vdict, const void* key) 
+{
+    size_t hash = vdict_hash(vdict, key);
+    if (vdict->size && vdict_hash_bsearch(vdict, hash, NULL)) {
+        unsigned char found = 0;
+        size_t checked = 0;
+        while (!found && checked < vdict->size) {
+            if (memcmp((unsigned char*)vdict_keys(vdict) + vdict->key_size * hash, vdict_zero_key(vdict), vdict->key_size) == 0) {
+                break;
+            } else if (memcmp((unsigned char*)vdict_keys(vdict) + vdict->key_size * hash, key, vdict->key_size) == 0) {
+                found = 1;
+                break;
+            } else {
+                hash = (hash + 1) % vdict->hash_pool;
+                checked++;
+            }
+        }
+
+        if (found) {
+            return (unsigned char*)vdict_values(vdict) + vdict->value_size * hash;
+        }
+    }
+    return NULL;
+}
+#endif
+
 #endif /* VD_VOID_DICT_H */
@@ -0,0 +1,352 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "void_flatmap.h"
+
+/*
+ * The descendants of `k` 3 levels below start at 8 * k, 8 integers of up to
+ * 8 bytes each fill one cache line, which is prefetched while `k` is compared
+ */
+#define VFMAP_PREFETCH_LEVELS 3
+
+#if defined(__GNUC__)
+#define PREFETCH(ptr) __builtin_prefetch(ptr)
+#else
+#define PREFETCH(ptr) ((void)0)
+#endif
+
+#define KEY(vfmap, idx) ((const unsigned char*)varr_data(&(vfmap)->keys) + (vfmap)->keys.value_size * (idx))
+#define VALUE(vfmap, idx) ((unsigned char*)varr_data(&(vfmap)->values) + (vfmap)->values.value_size * (idx))
+#define EYT_KEY(vfmap, k) ((const unsigned char*)varr_data(&(vfmap)->eyt_keys) + (vfmap)->eyt_keys.value_size * (k))
+
+static inline uint64_t
+vfmap_int(const void* key, size_t key_size)
+{
+    switch (key_size) {
+    case 1: { uint8_t k; memcpy(&k, key, 1); return k; }
+    case 2: { uint16_t k; memcpy(&k, key, 2); return k; }
+    case 4: { uint32_t k; memcpy(&k, key, 4); return k; }
+    default: { uint64_t k; memcpy(&k, key, 8); return k; }
+    }
+}
+
+/* Returns whether `a` < `b`, or `a` <= `b` if `or_equal` is set */
+static inline int
+vfmap_less(const struct void_flatmap* vfmap, const void* a, const void* b, int or_equal)
+{
+    if (vfmap->cmp) {
+        int c = vfmap->cmp(a, b);
+        return or_equal ? c <= 0 : c < 0;
+    } else {
+        uint64_t ka = vfmap_int(a, vfmap->keys.value_size), kb = vfmap_int(b, vfmap->keys.value_size);
+        return or_equal ? ka <= kb : ka < kb;
+    }
+}
+
+/* Index of the first sorted key not less than (greater than if `upper`) `key` */
+static size_t
+vfmap_bsearch(const struct void_flatmap* vfmap, const void* key, int upper)
+{
+    size_t low = 0, high = vfmap->keys.size;
+    while (low < high) {
+        size_t mid = low + ((high - low) >> 1);
+        if (vfmap_less(vfmap, KEY(vfmap, mid), key, upper)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/* Same as `vfmap_bsearch` on the Eytzinger layout, returns the found node (0 if none) */
+static size_t
+vfmap_eyt_node(const struct void_flatmap* vfmap, const void* key, int upper)
+{
+    size_t n = vfmap->keys.size;
+    size_t k = 1;
+
+    if (!vfmap->cmp && vfmap->keys.value_size == 8) {
+        const uint64_t* eyt = (const uint64_t*)varr_data(&vfmap->eyt_keys);
+        uint64_t x;
+        memcpy(&x, key, 8);
+        while (k <= n) {
+            PREFETCH(eyt + (k << VFMAP_PREFETCH_LEVELS));
+            k = 2 * k + (upper ? eyt[k] <= x : eyt[k] < x);
+        }
+    } else if (!vfmap->cmp && vfmap->keys.value_size == 4) {
+        const uint32_t* eyt = (const uint32_t*)varr_data(&vfmap->eyt_keys);
+        uint32_t x;
+        memcpy(&x, key, 4);
+        while (k <= n) {
+            PREFETCH(eyt + (k << VFMAP_PREFETCH_LEVELS));
+            k = 2 * k + (upper ? eyt[k] <= x : eyt[k] < x);
+        }
+    } else {
+        while (k <= n) {
+            PREFETCH(EYT_KEY(vfmap, k << VFMAP_PREFETCH_LEVELS));
+            k = 2 * k + vfmap_less(vfmap, EYT_KEY(vfmap, k), key, upper);
+        }
+    }
+    /* Strips the right turns taken after the last left turn, which was at the result */
+    return k >> __builtin_ffsl((long)~k);
+}
+
+/*
+ * Index in `keys` of node `k`, computed instead of loaded to save a cache miss.
+ * In a perfect tree down to the last level, the rank of `k` at depth `d` is
+ * (2 * (k - 2^d) + 1) * 2^(last - d) - 1 and the leaves have the even ranks.
+ * Leaves missing from the last level are subtracted.
+ */
+static inline size_t
+vfmap_eyt_rank(size_t n, size_t k)
+{
+    unsigned last = (unsigned)(sizeof(unsigned long) * 8 - 1) - (unsigned)__builtin_clzl(n);
+    unsigned depth = (unsigned)(sizeof(unsigned long) * 8 - 1) - (unsigned)__builtin_clzl(k);
+    size_t rank = ((2 * (k - ((size_t)1 << depth)) + 1) << (last - depth)) - 1;
+    size_t leaves = n - (((size_t)1 << last) - 1);
+    size_t leaves_before = (rank + 1) / 2;
+    return leaves_before > leaves ? rank - (leaves_before - leaves) : rank;
+}
+
+static inline size_t
+vfmap_eyt_search(const struct void_flatmap* vfmap, const void* key, int upper)
+{
+    size_t k = vfmap_eyt_node(vfmap, key, upper);
+    return k ? vfmap_eyt_rank(vfmap->keys.size, k) : vfmap->keys.size;
+}
+
+static inline size_t
+vfmap_search(const struct void_flatmap* vfmap, const void* key, int upper)
+{
+    return vfmap->dirty ? vfmap_bsearch(vfmap, key, upper) : vfmap_eyt_search(vfmap, key, upper);
+}
+
+/* Sets the size of `varray` to `n` zeroed values, it stays empty if the memory can't be allocated */
+static int
+vfmap_resize(struct void_array* varray, size_t n)
+{
+    unsigned long capacity = varray->capacity, doublings = 0;
+    varr_clear(varray);
+    /* an array without memory gets a capacity of 1 on the first doubling */
+    while (capacity < n) {
+        capacity = capacity ? capacity << 1 : 1;
+        doublings++;
+    }
+    varr_expand(varray, doublings);
+    /* a failed reallocation leaves the capacity unchanged */
+    if (varray->capacity < n) {
+        return VFMAP_ERROR;
+    }
+    varray->size = n;
+    return VFMAP_SUCCESS;
+}
+
+/* In-order traversal of the implicit tree, node `k` gets the `pos`th smallest key */
+static size_t
+vfmap_eyt_fill(struct void_flatmap* vfmap, size_t k, size_t pos)
+{
+    if (k <= vfmap->keys.size) {
+        pos = vfmap_eyt_fill(vfmap, 2 * k, pos);
+        memcpy((unsigned char*)EYT_KEY(vfmap, k), KEY(vfmap, pos), vfmap->keys.value_size);
+        pos++;
+        pos = vfmap_eyt_fill(vfmap, 2 * k + 1, pos);
+    }
+    return pos;
+}
+
+int
+vfmap_rebuild(struct void_flatmap* vfmap)
+{
+    if (vfmap) {
+        if (vfmap_resize(&vfmap->eyt_keys, vfmap->keys.size + 1) != VFMAP_SUCCESS) {
+            /* lookups fall back to the sorted keys */
+            vfmap->dirty = 1;
+            return VFMAP_ERROR;
+        }
+        vfmap_eyt_fill(vfmap, 1, 0);
+        vfmap->dirty = 0;
+        return VFMAP_SUCCESS;
+    }
+    return VFMAP_ERROR ^ VFMAP_MAP_404;
+}
+
+int
+vfmap_build(struct void_flatmap* vfmap, const void* keys, const void* values, size_t n)
+{
+    if (vfmap) {
+        const unsigned char* key_bytes = (const unsigned char*)keys;
+        const unsigned char* value_bytes = (const unsigned char*)values;
+        size_t key_size = vfmap->keys.value_size;
+        size_t* order = (size_t*)malloc(sizeof(size_t) * (n ? n : 1));
+        size_t* tmp = (size_t*)malloc(sizeof(size_t) * (n ? n : 1));
+
+        if (!order || !tmp) {
+            free(order);
+            free(tmp);
+            vfmap->dirty = 1;
+            return VFMAP_ERROR;
+        }
+        for (size_t i = 0; i < n; i++) {
+            order[i] = i;
+        }
+        /* Bottom-up merge sort of the indices, stable so the last of equal keys stays last */
+        for (size_t width = 1; width < n; width <<= 1) {
+            for (size_t low = 0; low < n; low += width << 1) {
+                size_t mid = low + width < n ? low + width : n;
+                size_t high = mid + width < n ? mid + width : n;
+                size_t l = low, r = mid, out = low;
+                while (l < mid && r < high) {
+                    if (vfmap_less(vfmap, key_bytes + key_size * order[r], key_bytes + key_size * order[l], 0)) {
+                        tmp[out++] = order[r++];
+                    } else {
+                        tmp[out++] = order[l++];
+                    }
+                }
+                while (l < mid) tmp[out++] = order[l++];
+                while (r < high) tmp[out++] = order[r++];
+            }
+            size_t* swap = order;
+            order = tmp;
+            tmp = swap;
+        }
+
+        varr_clear(&vfmap->keys);
+        varr_clear(&vfmap->values);
+        for (size_t i = 0; i < n; i++) {
+            if (i + 1 < n && !vfmap_less(vfmap, key_bytes + key_size * order[i], key_bytes + key_size * order[i + 1], 0)) {
+                continue;
+            }
+            if (varr_add(&vfmap->keys, key_bytes + key_size * order[i], 1) != VARR_SUCCESS
+                    || varr_add(&vfmap->values, value_bytes + vfmap->values.value_size * order[i], 1) != VARR_SUCCESS) {
+                /* keeps the pairs added so far, which are sorted */
+                vfmap->keys.size = vfmap->values.size;
+                free(order);
+                free(tmp);
+                vfmap->dirty = 1;
+                return VFMAP_ERROR;
+            }
+        }
+        free(order);
+        free(tmp);
+        return vfmap_rebuild(vfmap);
+    }
+    return VFMAP_ERROR ^ VFMAP_MAP_404;
+}
+
+int
+vfmap_insert(struct void_flatmap* vfmap, const void* key, const void* value)
+{
+    if (vfmap) {
+        size_t idx = vfmap_bsearch(vfmap, key, 0);
+        if (idx < vfmap->keys.size && !vfmap_less(vfmap, key, KEY(vfmap, idx), 0)) {
+            varr_replace(&vfmap->values, idx, (void*)value, 1);
+            return VFMAP_SUCCESS;
+        }
+        if (idx == vfmap->keys.size ? varr_add(&vfmap->keys, key, 1) : varr_insert(&vfmap->keys, idx, key, 1)) {
+            return VFMAP_ERROR;
+        }
+        vfmap->dirty = 1;
+        if (idx + 1 == vfmap->keys.size ? varr_add(&vfmap->values, value, 1) : varr_insert(&vfmap->values, idx, value, 1)) {
+            /* keys and values keep the same size */
+            varr_remove(&vfmap->keys, idx, 1);
+            return VFMAP_ERROR;
+        }
+        return VFMAP_SUCCESS;
+    }
+    return VFMAP_ERROR ^ VFMAP_MAP_404;
+}
+
+int
+vfmap_erase(struct void_flatmap* vfmap, const void* key)
+{
+    if (vfmap) {
+        size_t idx = vfmap_search(vfmap, key, 0);
+        if (idx < vfmap->keys.size && !vfmap_less(vfmap, key, KEY(vfmap, idx), 0)) {
+            varr_remove(&vfmap->keys, idx, 1);
+            varr_remove(&vfmap->values, idx, 1);
+            vfmap->dirty = 1;
+            return VFMAP_SUCCESS;
+        }
+        return VFMAP_ERROR ^ VFMAP_KEY_404;
+    }
+    return VFMAP_ERROR ^ VFMAP_MAP_404;
+}
+
+size_t
+vfmap_lower_bound(const struct void_flatmap* vfmap, const void* key)
+{
+    return vfmap_search(vfmap, key, 0);
+}
+
+void*
+vfmap_get(const struct void_flatmap* vfmap, const void* key)
+{
+    size_t idx;
+    if (!vfmap->dirty) {
+        /* the found node was just compared and is still cached, unlike the sorted key */
+        size_t k = vfmap_eyt_node(vfmap, key, 0);
+        if (k && !vfmap_less(vfmap, key, EYT_KEY(vfmap, k), 0)) {
+            return VALUE(vfmap, vfmap_eyt_rank(vfmap->keys.size, k));
+        }
+        return NULL;
+    }
+    idx = vfmap_bsearch(vfmap, key, 0);
+    if (idx < vfmap->keys.size && !vfmap_less(vfmap, key, KEY(vfmap, idx), 0)) {
+        return VALUE(vfmap, idx);
+    }
+    return NULL;
+}
+
+size_t
+vfmap_range(const struct void_flatmap* vfmap, const void* low, const void* high, size_t* first)
+{
+    size_t end = vfmap_search(vfmap, high, 1);
+    *first = vfmap_search(vfmap, low, 0);
+    return end > *first ? end - *first : 0;
+}
+
+int
+vfmap_init(struct void_flatmap* vfmap, size_t key_size, size_t value_size, int(*cmp)(const void*, const void*))
+{
+    if (vfmap) {
+        if (!key_size || (!cmp && key_size != 1 && key_size != 2 && key_size != 4 && key_size != 8)) {
+            return VFMAP_ERROR;
+        }
+        varr_init(&vfmap->keys, 1, key_size, NULL);
+        varr_init(&vfmap->values, 1, value_size, NULL);
+        varr_init(&vfmap->eyt_keys, 1, key_size, NULL);
+        vfmap->cmp = cmp;
+        vfmap->dirty = 0;
+        return VFMAP_SUCCESS;
+    }
+    return VFMAP_ERROR ^ VFMAP_MAP_404;
+}
+
+void
+vfmap_free(void* vfmap_ptr)
+{
+    struct void_flatmap* vfmap = (struct void_flatmap*)vfmap_ptr;
+    varr_free(&vfmap->keys);
+    varr_free(&vfmap->values);
+    varr_free(&vfmap->eyt_keys);
+    vfmap->cmp = NULL;
+    vfmap->dirty = 0;
+}
@@ -0,0 +1,152 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#ifndef VF_VOID_FLATMAP_H
+#define VF_VOID_FLATMAP_H
+
+#include <stdlib.h>
+
+#include "void_array.h"
+
+/**
+ * Error Codes
+ */
+#define VFMAP_SUCCESS               0
+#define VFMAP_ERROR                 1
+#define VFMAP_MAP_404               2
+#define VFMAP_KEY_404               3
+
+/**
+ * Void Flat Map Structure
+ * Sorted keys and values in two Void Arrays for ordered iteration and ranges.
+ * Lookups search a copy of the keys in Eytzinger (BFS) order, which keeps
+ * the first levels of the search in few cache lines and lets the next
+ * levels be prefetched. Meant for read-mostly maps: inserts and erases
+ * fall back to binary search until `vfmap_rebuild` is called.
+ */
+struct void_flatmap {
+    /** keys in ascending order */
+    struct void_array keys;
+    /** value of each key in `keys` */
+    struct void_array values;
+    /** keys in Eytzinger order, starting at index 1 */
+    struct void_array eyt_keys;
+    /** comparison function returning <0, 0 or >0 like `memcmp` (NULL for unsigned integer keys) */
+    int(*cmp)(const void*, const void*);
+    /** whether `eyt_keys` is outdated */
+    int dirty;
+};
+
+/**
+ * Replaces the contents with `n` key-value pairs.
+ * Pairs don't have to be sorted, of equal keys the last one is kept.
+ *
+ * @param vfmap Void Flat Map to build
+ * @param keys Array of `n` keys
+ * @param values Array of `n` values
+ * @param n Amount of key-value pairs
+ * @return Error Code
+ */
+int
+vfmap_build(struct void_flatmap* vfmap, const void* keys, const void* values, size_t n);
+
+/**
+ * Inserts a key-value pair or replaces the value of an existing key in O(n).
+ * Lookups use binary search until the next `vfmap_rebuild`.
+ *
+ * @param vfmap Void Flat Map to insert into
+ * @param key Key to insert
+ * @param value Value to insert
+ * @return Error Code
+ */
+int
+vfmap_insert(struct void_flatmap* vfmap, const void* key, const void* value);
+
+/**
+ * Erases the key-value pair of `key` in O(n).
+ * Lookups use binary search until the next `vfmap_rebuild`.
+ *
+ * @param vfmap Void Flat Map to erase from
+ * @param key Key to erase
+ * @return Error Code
+ */
+int
+vfmap_erase(struct void_flatmap* vfmap, const void* key);
+
+/**
+ * Rebuilds the Eytzinger layout after inserts or erases.
+ *
+ * @param vfmap Void Flat Map to rebuild
+ * @return Error Code
+ */
+int
+vfmap_rebuild(struct void_flatmap* vfmap);
+
+/**
+ * Returns the index in `vfmap->keys` of the first key not less than `key`.
+ *
+ * @param vfmap Void Flat Map to search
+ * @param key Key to search for
+ * @return Index of the key (`vfmap->keys.size` if all keys are less)
+ */
+size_t
+vfmap_lower_bound(const struct void_flatmap* vfmap, const void* key);
+
+/**
+ * Returns pointer to the value of `key`.
+ *
+ * @param vfmap Void Flat Map to get the value from
+ * @param key Key to get the value of
+ * @return Pointer to the value (NULL if not found)
+ */
+void*
+vfmap_get(const struct void_flatmap* vfmap, const void* key);
+
+/**
+ * Finds all keys in [`low`, `high`], which are at the indices
+ * [`*first`, `*first + count`) of `vfmap->keys` and `vfmap->values`.
+ *
+ * @param vfmap Void Flat Map to search
+ * @param low Smallest key of the range
+ * @param high Largest key of the range
+ * @param first Set to the index of the first key in range
+ * @return Amount of keys in range
+ */
+size_t
+vfmap_range(const struct void_flatmap* vfmap, const void* low, const void* high, size_t* first);
+
+/**
+ * Initializes a Void Flat Map.
+ *
+ * @param vfmap Void Flat Map to be initialized
+ * @param key_size Size of Keys in Bytes (1, 2, 4 or 8 if `cmp` is NULL)
+ * @param value_size Size of Values in Bytes
+ * @param cmp Comparison function for keys (NULL to compare them as unsigned integers)
+ * @return Error Code
+ */
+int
+vfmap_init(struct void_flatmap* vfmap, size_t key_size, size_t value_size, int(*cmp)(const void*, const void*));
+
+/**
+ * Assumes `vfmap_ptr` is of type `struct void_flatmap*`.
+ * Frees all allocated data of the Flat Map.
+ *
+ * @param vfmap_ptr Void Flat Map of which the content is to be freed
+ */
+void
+vfmap_free(void* vfmap_ptr);
+
+#endif /* VF_VOID_FLATMAP_H */
@@ -0,0 +1,395 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "void_heap.h"
+
+/* Marks positions of free handles, the remaining bits hold the next free handle */
+#define VHEAP_FREE_BIT (~(VHEAP_NULL >> 1))
+
+/* A handle holds the generation of its slot in the upper and the slot in the lower half */
+#define VHEAP_SLOT_BITS (sizeof(size_t) * CHAR_BIT / 2)
+#define VHEAP_SLOT_MASK (((size_t)1 << VHEAP_SLOT_BITS) - 1)
+
+#define HANDLE(slot, generation) (((size_t)(generation) << VHEAP_SLOT_BITS) | (slot))
+#define HANDLE_SLOT(handle) ((handle) & VHEAP_SLOT_MASK)
+#define HANDLE_GENERATION(handle) ((handle) >> VHEAP_SLOT_BITS)
+
+#define VALUE(vheap, pos) ((unsigned char*)varr_data(&(vheap)->values) + (vheap)->values.value_size * (pos))
+#define HANDLES(vheap) ((size_t*)varr_data(&(vheap)->value_handles))
+#define POSITIONS(vheap) ((size_t*)varr_data(&(vheap)->positions))
+#define GENERATIONS(vheap) ((size_t*)varr_data(&(vheap)->generations))
+
+static inline uint64_t
+vheap_key(const struct void_heap* vheap, const unsigned char* value)
+{
+    const unsigned char* key = value + vheap->key_offset;
+    switch (vheap->key_width) {
+    case 1: { uint8_t k; memcpy(&k, key, 1); return vheap->key_signed ? (uint64_t)(int64_t)(int8_t)k : k; }
+    case 2: { uint16_t k; memcpy(&k, key, 2); return vheap->key_signed ? (uint64_t)(int64_t)(int16_t)k : k; }
+    case 4: { uint32_t k; memcpy(&k, key, 4); return vheap->key_signed ? (uint64_t)(int64_t)(int32_t)k : k; }
+    default: { uint64_t k; memcpy(&k, key, 8); return k; }
+    }
+}
+
+static inline int
+vheap_less(const struct void_heap* vheap, const unsigned char* a, const unsigned char* b)
+{
+    if (vheap->key_width) {
+        uint64_t ka = vheap_key(vheap, a), kb = vheap_key(vheap, b);
+        if (vheap->key_signed) {
+            return (int64_t)ka < (int64_t)kb;
+        }
+        return ka < kb;
+    }
+    return vheap->cmp(a, b) < 0;
+}
+
+/* `handle` and `slot` below are slots, handles with their generation only leave through the API */
+static inline void
+vheap_move(struct void_heap* vheap, size_t from, size_t to)
+{
+    memcpy(VALUE(vheap, to), VALUE(vheap, from), vheap->values.value_size);
+    HANDLES(vheap)[to] = HANDLES(vheap)[from];
+    POSITIONS(vheap)[HANDLES(vheap)[to]] = to;
+}
+
+static inline void
+vheap_place(struct void_heap* vheap, size_t pos, size_t handle)
+{
+    memcpy(VALUE(vheap, pos), vheap->hole, vheap->values.value_size);
+    HANDLES(vheap)[pos] = handle;
+    POSITIONS(vheap)[handle] = pos;
+}
+
+/* Moves the value in `vheap->hole` from `pos` towards the root, parents move down into the hole */
+static size_t
+vheap_sift_up(struct void_heap* vheap, size_t pos, size_t handle)
+{
+    while (pos > 0) {
+        size_t parent = (pos - 1) / vheap->arity;
+        if (!vheap_less(vheap, vheap->hole, VALUE(vheap, parent))) break;
+        vheap_move(vheap, parent, pos);
+        pos = parent;
+    }
+    vheap_place(vheap, pos, handle);
+    return pos;
+}
+
+/* Moves the value in `vheap->hole` from `pos` towards the leaves, smallest children move up */
+static size_t
+vheap_sift_down(struct void_heap* vheap, size_t pos, size_t handle)
+{
+    size_t size = vheap->values.size;
+    for (;;) {
+        size_t first = pos * vheap->arity + 1;
+        size_t last, best;
+        if (first >= size) break;
+        last = size - first > vheap->arity ? first + vheap->arity : size;
+        best = first;
+        for (size_t child = first + 1; child < last; child++) {
+            if (vheap_less(vheap, VALUE(vheap, child), VALUE(vheap, best))) best = child;
+        }
+        if (!vheap_less(vheap, VALUE(vheap, best), vheap->hole)) break;
+        vheap_move(vheap, best, pos);
+        pos = best;
+    }
+    vheap_place(vheap, pos, handle);
+    return pos;
+}
+
+static inline size_t
+vheap_position(const struct void_heap* vheap, size_t handle)
+{
+    size_t slot = HANDLE_SLOT(handle);
+    if (slot < vheap->positions.size && GENERATIONS(vheap)[slot] == HANDLE_GENERATION(handle)
+            && !(POSITIONS(vheap)[slot] & VHEAP_FREE_BIT)) {
+        return POSITIONS(vheap)[slot];
+    }
+    return VHEAP_NULL;
+}
+
+/* Frees the slot, the new generation makes all its handles stale */
+static inline void
+vheap_release_handle(struct void_heap* vheap, size_t slot)
+{
+    GENERATIONS(vheap)[slot] = (GENERATIONS(vheap)[slot] + 1) & VHEAP_SLOT_MASK;
+    POSITIONS(vheap)[slot] = VHEAP_FREE_BIT | vheap->free_handle;
+    vheap->free_handle = slot;
+}
+
+/* Appends `n` slots of generation 0, their handles equal the slots */
+static int
+vheap_add_slots(struct void_heap* vheap, size_t n)
+{
+    const size_t zero = 0;
+    size_t first = vheap->positions.size;
+    /* the last slot stays unused, so no handle equals VHEAP_NULL */
+    if (n > VHEAP_SLOT_MASK - first) {
+        return VHEAP_ERROR;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (varr_add(&vheap->generations, &zero, 1) != VARR_SUCCESS) {
+            vheap->generations.size = first;
+            return VHEAP_ERROR;
+        }
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (varr_add(&vheap->positions, &zero, 1) != VARR_SUCCESS) {
+            vheap->generations.size = first;
+            vheap->positions.size = first;
+            return VHEAP_ERROR;
+        }
+    }
+    return VHEAP_SUCCESS;
+}
+
+/* Drops everything appended after a failed push or heapify, the new slots were never handed out */
+static void
+vheap_truncate(struct void_heap* vheap, size_t size, size_t slots)
+{
+    vheap->values.size = size;
+    vheap->value_handles.size = size;
+    vheap->positions.size = slots;
+    vheap->generations.size = slots;
+}
+
+/* Removes the value at `pos` by sifting the last value into its place */
+static void
+vheap_take(struct void_heap* vheap, size_t pos)
+{
+    size_t last = vheap->values.size - 1;
+    vheap_release_handle(vheap, HANDLES(vheap)[pos]);
+    vheap->values.size--;
+    vheap->value_handles.size--;
+    if (pos != last) {
+        size_t handle = HANDLES(vheap)[last];
+        memcpy(vheap->hole, VALUE(vheap, last), vheap->values.value_size);
+        if (vheap_sift_down(vheap, pos, handle) == pos) {
+            vheap_sift_up(vheap, pos, handle);
+        }
+    }
+}
+
+int
+vheap_set_key(struct void_heap* vheap, size_t key_offset, size_t key_width, int key_signed)
+{
+    if (vheap) {
+        if (vheap->values.size || (key_width != 0 && key_width != 1 && key_width != 2 && key_width != 4 && key_width != 8)
+                || key_offset + key_width > vheap->values.value_size) {
+            return VHEAP_ERROR;
+        }
+        vheap->key_offset = key_offset;
+        vheap->key_width = key_width;
+        vheap->key_signed = key_signed;
+        return VHEAP_SUCCESS;
+    }
+    return VHEAP_ERROR ^ VHEAP_HEAP_404;
+}
+
+size_t
+vheap_push(struct void_heap* vheap, const void* data)
+{
+    if (vheap) {
+        const size_t size = vheap->values.size;
+        const size_t slots = vheap->positions.size;
+        const size_t free_handle = vheap->free_handle;
+        size_t slot;
+
+        if (free_handle != VHEAP_NULL) {
+            slot = free_handle;
+            vheap->free_handle = POSITIONS(vheap)[slot] == VHEAP_NULL ? VHEAP_NULL : POSITIONS(vheap)[slot] & ~VHEAP_FREE_BIT;
+        } else {
+            slot = slots;
+            if (vheap_add_slots(vheap, 1) != VHEAP_SUCCESS) {
+                return VHEAP_NULL;
+            }
+        }
+        if (varr_add(&vheap->values, data, 1) != VARR_SUCCESS
+                || varr_add(&vheap->value_handles, &slot, 1) != VARR_SUCCESS) {
+            /* a reused slot still holds its link in the free list */
+            vheap_truncate(vheap, size, slots);
+            vheap->free_handle = free_handle;
+            return VHEAP_NULL;
+        }
+        memcpy(vheap->hole, data, vheap->values.value_size);
+        vheap_sift_up(vheap, size, slot);
+        return HANDLE(slot, GENERATIONS(vheap)[slot]);
+    }
+    return VHEAP_NULL;
+}
+
+int
+vheap_heapify(struct void_heap* vheap, const void* data, size_t n, size_t* first_handle)
+{
+    if (vheap) {
+        const size_t size = vheap->values.size;
+        size_t first = vheap->positions.size;
+        if (first_handle) {
+            *first_handle = first;
+        }
+        if (!n) {
+            return VHEAP_SUCCESS;
+        }
+        if (vheap_add_slots(vheap, n) != VHEAP_SUCCESS) {
+            return VHEAP_ERROR;
+        }
+        if (varr_add(&vheap->values, data, n) != VARR_SUCCESS) {
+            vheap_truncate(vheap, size, first);
+            return VHEAP_ERROR;
+        }
+        for (size_t i = 0; i < n; i++) {
+            size_t slot = first + i;
+            POSITIONS(vheap)[slot] = vheap->value_handles.size;
+            if (varr_add(&vheap->value_handles, &slot, 1) != VARR_SUCCESS) {
+                vheap_truncate(vheap, size, first);
+                return VHEAP_ERROR;
+            }
+        }
+
+        /* Floyd's construction, sifts every inner node down once starting at the last one */
+        for (size_t pos = vheap->values.size > 1 ? (vheap->values.size - 2) / vheap->arity + 1 : 0; pos-- > 0; ) {
+            memcpy(vheap->hole, VALUE(vheap, pos), vheap->values.value_size);
+            vheap_sift_down(vheap, pos, HANDLES(vheap)[pos]);
+        }
+        return VHEAP_SUCCESS;
+    }
+    return VHEAP_ERROR ^ VHEAP_HEAP_404;
+}
+
+const void*
+vheap_top(const struct void_heap* vheap)
+{
+    return vheap->values.size ? VALUE(vheap, 0) : NULL;
+}
+
+const void*
+vheap_get(const struct void_heap* vheap, size_t handle)
+{
+    size_t pos = vheap_position(vheap, handle);
+    return pos != VHEAP_NULL ? VALUE(vheap, pos) : NULL;
+}
+
+int
+vheap_pop(struct void_heap* vheap, void* out)
+{
+    if (vheap) {
+        if (!vheap->values.size) {
+            return VHEAP_ERROR ^ VHEAP_EMPTY;
+        }
+        if (out) {
+            memcpy(out, VALUE(vheap, 0), vheap->values.value_size);
+        }
+        vheap_take(vheap, 0);
+        return VHEAP_SUCCESS;
+    }
+    return VHEAP_ERROR ^ VHEAP_HEAP_404;
+}
+
+int
+vheap_update(struct void_heap* vheap, size_t handle, const void* data)
+{
+    if (vheap) {
+        size_t pos = vheap_position(vheap, handle);
+        if (pos == VHEAP_NULL) {
+            return VHEAP_ERROR ^ VHEAP_STALE_HANDLE;
+        }
+        memcpy(vheap->hole, data, vheap->values.value_size);
+        if (vheap_sift_down(vheap, pos, HANDLE_SLOT(handle)) == pos) {
+            vheap_sift_up(vheap, pos, HANDLE_SLOT(handle));
+        }
+        return VHEAP_SUCCESS;
+    }
+    return VHEAP_ERROR ^ VHEAP_HEAP_404;
+}
+
+int
+vheap_remove(struct void_heap* vheap, size_t handle)
+{
+    if (vheap) {
+        size_t pos = vheap_position(vheap, handle);
+        if (pos == VHEAP_NULL) {
+            return VHEAP_ERROR ^ VHEAP_STALE_HANDLE;
+        }
+        vheap_take(vheap, pos);
+        return VHEAP_SUCCESS;
+    }
+    return VHEAP_ERROR ^ VHEAP_HEAP_404;
+}
+
+int
+vheap_clear(struct void_heap* vheap)
+{
+    if (vheap) {
+        /* slots are kept, so their generations keep old handles stale */
+        for (size_t pos = 0; pos < vheap->value_handles.size; pos++) {
+            vheap_release_handle(vheap, HANDLES(vheap)[pos]);
+        }
+        varr_clear(&vheap->values);
+        varr_clear(&vheap->value_handles);
+        return VHEAP_SUCCESS;
+    }
+    return VHEAP_ERROR ^ VHEAP_HEAP_404;
+}
+
+int
+vheap_init(struct void_heap* vheap, unsigned long init_capacity, size_t value_size, size_t arity, int(*cmp)(const void*, const void*))
+{
+    if (vheap) {
+        if (arity < 2) {
+            return VHEAP_ERROR;
+        }
+        int error = 0;
+        if (!init_capacity) init_capacity = 1;
+        error |= varr_init(&vheap->values, init_capacity, value_size, NULL);
+        error |= varr_init(&vheap->value_handles, init_capacity, sizeof(size_t), NULL);
+        error |= varr_init(&vheap->positions, init_capacity, sizeof(size_t), NULL);
+        error |= varr_init(&vheap->generations, init_capacity, sizeof(size_t), NULL);
+        vheap->free_handle = VHEAP_NULL;
+        vheap->arity = arity;
+        vheap->cmp = cmp;
+        vheap->key_offset = 0;
+        vheap->key_width = 0;
+        vheap->key_signed = 0;
+        vheap->hole = (unsigned char*)valloc_alloc(vheap->values.allocator, value_size);
+        if (error || (!vheap->hole && value_size)) {
+            vheap_free(vheap);
+            return VHEAP_ERROR;
+        }
+        return VHEAP_SUCCESS;
+    }
+    return VHEAP_ERROR ^ VHEAP_HEAP_404;
+}
+
+void
+vheap_free(void* vheap_ptr)
+{
+    struct void_heap* vheap = (struct void_heap*)vheap_ptr;
+    valloc_free(vheap->values.allocator, vheap->hole, vheap->values.value_size);
+    varr_free(&vheap->values);
+    varr_free(&vheap->value_handles);
+    varr_free(&vheap->positions);
+    varr_free(&vheap->generations);
+    vheap->hole = NULL;
+    vheap->free_handle = VHEAP_NULL;
+    vheap->arity = 0;
+    vheap->cmp = NULL;
+    vheap->key_width = 0;
+}
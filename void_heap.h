@@ -0,0 +1,191 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#ifndef VH_VOID_HEAP_H
+#define VH_VOID_HEAP_H
+
+#include <stdlib.h>
+
+#include "void_array.h"
+
+/**
+ * Error Codes
+ */
+#define VHEAP_SUCCESS               0
+#define VHEAP_ERROR                 1
+#define VHEAP_HEAP_404              2
+#define VHEAP_EMPTY                 3
+#define VHEAP_STALE_HANDLE          4
+
+/**
+ * Handle which never refers to a value
+ */
+#define VHEAP_NULL                  ((size_t)-1)
+
+/**
+ * Void Heap Structure
+ * d-ary min-heap, the smallest value according to `cmp`
+ * or the integer key is on top.
+ * A handle holds the generation of its slot in the upper and the slot
+ * in the lower half of its bits, so handles of removed values stay stale
+ * even after their slot got reused.
+ */
+struct void_heap {
+    /** values in heap order */
+    struct void_array values;
+    /** slot of each value in `values` */
+    struct void_array value_handles;
+    /** position in `values` of each slot or next free slot */
+    struct void_array positions;
+    /** generation of each slot, incremented whenever its value is removed */
+    struct void_array generations;
+    /** first free slot (VHEAP_NULL if none) */
+    size_t free_handle;
+    /** amount of children per node */
+    size_t arity;
+    /** comparison function returning <0, 0 or >0 like `memcmp` */
+    int(*cmp)(const void*, const void*);
+    /** byte offset of the integer key inside a value */
+    size_t key_offset;
+    /** size of the integer key in bytes (0 to use `cmp`) */
+    size_t key_width;
+    /** whether the integer key is signed */
+    int key_signed;
+    /** buffer of one value used while sifting */
+    unsigned char* hole;
+};
+
+/**
+ * Compares values by an integer key of `key_width` bytes (1, 2, 4 or 8)
+ * at `key_offset` instead of calling `vheap->cmp`.
+ * Has to be set while the heap is empty.
+ *
+ * @param vheap Void Heap to set the key of
+ * @param key_offset Byte offset of the key inside a value
+ * @param key_width Size of the key in bytes (0 to use `cmp` again)
+ * @param key_signed Whether the key is a signed integer
+ * @return Error Code
+ */
+int
+vheap_set_key(struct void_heap* vheap, size_t key_offset, size_t key_width, int key_signed);
+
+/**
+ * Copies `data` into the heap.
+ *
+ * @param vheap Void Heap to push to
+ * @param data Data of size `vheap->values.value_size` to be copied
+ * @return Handle of the value (VHEAP_NULL on failure)
+ */
+size_t
+vheap_push(struct void_heap* vheap, const void* data);
+
+/**
+ * Copies `n` values of `data` into the heap and restores the heap
+ * order once for all of them.
+ * The values get consecutive handles in the order of `data`.
+ *
+ * @param vheap Void Heap to push to
+ * @param data Array of values to be copied
+ * @param n Amount of values
+ * @param first_handle Set to the handle of the first value (Nullable)
+ * @return Error Code
+ */
+int
+vheap_heapify(struct void_heap* vheap, const void* data, size_t n, size_t* first_handle);
+
+/**
+ * Returns pointer to the smallest value.
+ *
+ * @param vheap Void Heap to get the value from
+ * @return Pointer to the value (NULL if empty)
+ */
+const void*
+vheap_top(const struct void_heap* vheap);
+
+/**
+ * Returns pointer to the value of `handle`.
+ *
+ * @param vheap Void Heap to get the value from
+ * @param handle Handle returned by `vheap_push` or `vheap_heapify`
+ * @return Pointer to the value (NULL if the handle is stale)
+ */
+const void*
+vheap_get(const struct void_heap* vheap, size_t handle);
+
+/**
+ * Copies the smallest value into `out` and removes it.
+ *
+ * @param vheap Void Heap to pop from
+ * @param out Memory to copy the value into (Nullable)
+ * @return Error Code
+ */
+int
+vheap_pop(struct void_heap* vheap, void* out);
+
+/**
+ * Replaces the value of `handle` with `data` and moves it
+ * up (decrease-key) or down (increase-key) accordingly.
+ *
+ * @param vheap Void Heap to update
+ * @param handle Handle of the value
+ * @param data New value
+ * @return Error Code
+ */
+int
+vheap_update(struct void_heap* vheap, size_t handle, const void* data);
+
+/**
+ * Removes the value of `handle`.
+ *
+ * @param vheap Void Heap to remove from
+ * @param handle Handle of the value
+ * @return Error Code
+ */
+int
+vheap_remove(struct void_heap* vheap, size_t handle);
+
+/**
+ * Removes all values, all handles become stale.
+ *
+ * @param vheap Void Heap to be cleared
+ * @return Error Code
+ */
+int
+vheap_clear(struct void_heap* vheap);
+
+/**
+ * Initializes a Void Heap.
+ *
+ * @param vheap Void Heap to be initialized
+ * @param init_capacity Initial Memory Capacity of the Void Heap
+ * @param value_size Size of Values to be saved (in Bytes)
+ * @param arity Amount of children per node (2, 4 and 8 are the sensible ones)
+ * @param cmp Comparison function (Nullable if an integer key is set)
+ * @return Error Code (`VHEAP_ERROR` if the memory couldn't be allocated, nothing is left to free then)
+ */
+int
+vheap_init(struct void_heap* vheap, unsigned long init_capacity, size_t value_size, size_t arity, int(*cmp)(const void*, const void*));
+
+/**
+ * Assumes `vheap_ptr` is of type `struct void_heap*`.
+ * Frees all allocated data of the heap.
+ *
+ * @param vheap_ptr Void Heap of which the content is to be freed
+ */
+void
+vheap_free(void* vheap_ptr);
+
+#endif /* VH_VOID_HEAP_H */
@@ -0,0 +1,299 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#include <stddef.h>
+#include <string.h>
+
+#include "void_packed.h"
+
+/* Words reserved per block on init, enough for 8 bits per value */
+#define VPACK_INIT_WORDS 16
+/* Values per lane of a block */
+#define VPACK_STEPS (VPACK_BLOCK / VPACK_LANES)
+
+#define BLOCK(vpack, b) ((const struct vpack_block*)varr_data(&(vpack)->blocks) + (b))
+#define WORDS(vpack) ((const uint64_t*)varr_data(&(vpack)->words))
+
+static inline unsigned
+vpack_width(const uint64_t x)
+{
+    return x ? 64 - (unsigned)__builtin_clzll(x) : 0;
+}
+
+static inline uint64_t
+vpack_mask(const unsigned bits)
+{
+    return bits == 64 ? ~UINT64_C(0) : (UINT64_C(1) << bits) - 1;
+}
+
+/* Amount of words of a block with `bits` bits per value, every lane gets whole words */
+static inline unsigned long
+vpack_block_words(const unsigned bits)
+{
+    return VPACK_LANES * ((VPACK_STEPS * bits + 63) / 64);
+}
+
+/*
+ * Value `i` of a block, it may straddle two words of its lane.
+ * The zero words after the last block keep the next word readable,
+ * shifting by 1 and then by `63 - sh` avoids an undefined shift by 64.
+ */
+static inline uint64_t
+vpack_extract(const uint64_t* words, const unsigned bits, const uint64_t mask, const unsigned long i)
+{
+    const unsigned long bit = (i / VPACK_LANES) * bits;
+    const uint64_t* lo = words + VPACK_LANES * (bit >> 6) + i % VPACK_LANES;
+    const unsigned sh = bit & 63;
+    return ((lo[0] >> sh) | ((lo[VPACK_LANES] << 1) << (63 - sh))) & mask;
+}
+
+/* Decodes all values of sealed block `b` into `out`, `restrict` lets the lanes become one vector */
+static void
+vpack_decode_block(const struct void_packed* vpack, const unsigned long b, uint64_t* restrict out)
+{
+    const struct vpack_block* block = BLOCK(vpack, b);
+    const uint64_t* restrict words = WORDS(vpack) + block->offset;
+    const unsigned bits = block->bits;
+    const uint64_t mask = vpack_mask(bits);
+
+    if (bits) {
+        /* the same shifts for all lanes, on contiguous words */
+        for (unsigned long step = 0; step < VPACK_STEPS; step++) {
+            const unsigned long bit = step * bits;
+            const uint64_t* lo = words + VPACK_LANES * (bit >> 6);
+            const uint64_t* hi = lo + VPACK_LANES;
+            const unsigned sh = bit & 63;
+            for (unsigned long lane = 0; lane < VPACK_LANES; lane++) {
+                out[VPACK_LANES * step + lane] = ((lo[lane] >> sh) | ((hi[lane] << 1) << (63 - sh))) & mask;
+            }
+        }
+    } else {
+        memset(out, 0, sizeof(uint64_t) * VPACK_BLOCK);
+    }
+    if (block->delta) {
+        /* prefix sums per lane, each step adds one vector */
+        for (unsigned long i = 0; i < VPACK_LANES; i++) {
+            out[i] += block->base;
+        }
+        for (unsigned long i = VPACK_LANES; i < VPACK_BLOCK; i++) {
+            out[i] += out[i - VPACK_LANES];
+        }
+    } else {
+        for (unsigned long i = 0; i < VPACK_BLOCK; i++) {
+            out[i] += block->base;
+        }
+    }
+}
+
+/* Appends the `VPACK_LANES` zero words, unless they are there already */
+static int
+vpack_zero_words(struct void_packed* vpack)
+{
+    const uint64_t zero[VPACK_LANES] = {0};
+    if (vpack->words.size < VPACK_LANES && varr_add(&vpack->words, zero, VPACK_LANES) != VARR_SUCCESS) {
+        return VPACK_ERROR;
+    }
+    return VPACK_SUCCESS;
+}
+
+/* Packs the full `tail` into a new block */
+static int
+vpack_seal(struct void_packed* vpack)
+{
+    const uint64_t* values = vpack->tail;
+    uint64_t packed[VPACK_BLOCK] = {0};
+    uint64_t min = values[0], max = values[0], max_delta = 0;
+    int ascending = 1;
+    unsigned for_bits, delta_bits;
+    struct vpack_block block;
+
+    /* a failed init or clear may have left them out */
+    if (vpack_zero_words(vpack) != VPACK_SUCCESS) {
+        return VPACK_ERROR;
+    }
+    for (unsigned long i = 1; i < VPACK_BLOCK; i++) {
+        const uint64_t prev = i < VPACK_LANES ? values[0] : values[i - VPACK_LANES];
+        if (values[i] < min) min = values[i];
+        if (values[i] > max) max = values[i];
+        if (values[i] < prev) {
+            ascending = 0;
+        } else if (values[i] - prev > max_delta) {
+            max_delta = values[i] - prev;
+        }
+    }
+    for_bits = vpack_width(max - min);
+    delta_bits = ascending ? vpack_width(max_delta) : 65;
+
+    block.delta = delta_bits < for_bits;
+    block.bits = (unsigned char)(block.delta ? delta_bits : for_bits);
+    block.base = block.delta ? values[0] : min;
+    block.offset = vpack->words.size - VPACK_LANES;
+    for (unsigned long i = 0; i < VPACK_BLOCK && block.bits; i++) {
+        const uint64_t r = block.delta
+            ? values[i] - (i < VPACK_LANES ? values[0] : values[i - VPACK_LANES])
+            : values[i] - min;
+        const unsigned long bit = (i / VPACK_LANES) * block.bits;
+        const unsigned long w = VPACK_LANES * (bit >> 6) + i % VPACK_LANES;
+        const unsigned sh = bit & 63;
+        packed[w] |= r << sh;
+        if (sh && sh + block.bits > 64) {
+            packed[w + VPACK_LANES] |= r >> (64 - sh);
+        }
+    }
+
+    /* in front of the zero words, which stay last */
+    if (block.bits && varr_insert(&vpack->words, block.offset, packed, vpack_block_words(block.bits)) != VARR_SUCCESS) {
+        return VPACK_ERROR;
+    }
+    if (varr_add(&vpack->blocks, &block, 1) != VARR_SUCCESS) {
+        return VPACK_ERROR;
+    }
+    return VPACK_SUCCESS;
+}
+
+int
+vpack_add(struct void_packed* vpack, const uint64_t* values, const unsigned long n)
+{
+    if (vpack) {
+        unsigned long added = 0;
+        while (added < n) {
+            unsigned long take = VPACK_BLOCK - vpack->tail_size;
+            if (take > n - added) {
+                take = n - added;
+            }
+            memcpy(vpack->tail + vpack->tail_size, values + added, sizeof(uint64_t) * take);
+            vpack->tail_size += take;
+            vpack->size += take;
+            added += take;
+            if (vpack->tail_size == VPACK_BLOCK) {
+                if (vpack_seal(vpack) != VPACK_SUCCESS) {
+                    vpack->tail_size -= take;
+                    vpack->size -= take;
+                    return VPACK_ERROR;
+                }
+                vpack->tail_size = 0;
+            }
+        }
+        return VPACK_SUCCESS;
+    }
+    return VPACK_ERROR ^ VPACK_ARRAY_404;
+}
+
+int
+vpack_get(const struct void_packed* vpack, const unsigned long idx, uint64_t* value)
+{
+    if (vpack) {
+        const unsigned long b = idx / VPACK_BLOCK;
+        const unsigned long i = idx % VPACK_BLOCK;
+
+        if (idx >= vpack->size) {
+            return VPACK_ERROR ^ VPACK_INDEX_OUT_OF_RANGE;
+        }
+        if (b < vpack->blocks.size) {
+            const struct vpack_block* block = BLOCK(vpack, b);
+            const uint64_t* words = WORDS(vpack) + block->offset;
+            const uint64_t mask = vpack_mask(block->bits);
+            uint64_t v = block->base;
+
+            if (block->bits && block->delta) {
+                for (unsigned long j = i % VPACK_LANES; j <= i; j += VPACK_LANES) {
+                    v += vpack_extract(words, block->bits, mask, j);
+                }
+            } else if (block->bits) {
+                v += vpack_extract(words, block->bits, mask, i);
+            }
+            *value = v;
+        } else {
+            *value = vpack->tail[i];
+        }
+        return VPACK_SUCCESS;
+    }
+    return VPACK_ERROR ^ VPACK_ARRAY_404;
+}
+
+int
+vpack_decode(const struct void_packed* vpack, const unsigned long idx, const unsigned long n, uint64_t* out)
+{
+    if (vpack) {
+        unsigned long done = 0;
+
+        if (idx + n > vpack->size || idx + n < idx) {
+            return VPACK_ERROR ^ VPACK_INDEX_OUT_OF_RANGE;
+        }
+        while (done < n) {
+            const unsigned long b = (idx + done) / VPACK_BLOCK;
+            const unsigned long i = (idx + done) % VPACK_BLOCK;
+            unsigned long take = VPACK_BLOCK - i;
+            if (take > n - done) {
+                take = n - done;
+            }
+
+            if (b == vpack->blocks.size) {
+                memcpy(out + done, vpack->tail + i, sizeof(uint64_t) * take);
+            } else if (take == VPACK_BLOCK) {
+                vpack_decode_block(vpack, b, out + done);
+            } else {
+                uint64_t block[VPACK_BLOCK];
+                vpack_decode_block(vpack, b, block);
+                memcpy(out + done, block + i, sizeof(uint64_t) * take);
+            }
+            done += take;
+        }
+        return VPACK_SUCCESS;
+    }
+    return VPACK_ERROR ^ VPACK_ARRAY_404;
+}
+
+int
+vpack_clear(struct void_packed* vpack)
+{
+    if (vpack) {
+        varr_clear(&vpack->blocks);
+        varr_clear(&vpack->words);
+        vpack->tail_size = 0;
+        vpack->size = 0;
+        return vpack_zero_words(vpack);
+    }
+    return VPACK_ERROR ^ VPACK_ARRAY_404;
+}
+
+int
+vpack_init(struct void_packed* vpack, const unsigned long init_blocks)
+{
+    if (vpack) {
+        const unsigned long blocks = init_blocks ? init_blocks : 1;
+        int error = 0;
+        /* arrays left without memory grow on the first seal */
+        error |= varr_init(&vpack->blocks, blocks, sizeof(struct vpack_block), NULL);
+        error |= varr_init(&vpack->words, blocks * VPACK_INIT_WORDS + VPACK_LANES, sizeof(uint64_t), NULL);
+        error |= vpack_zero_words(vpack);
+        memset(vpack->tail, 0, sizeof(vpack->tail));
+        vpack->tail_size = 0;
+        vpack->size = 0;
+        return error ? VPACK_ERROR : VPACK_SUCCESS;
+    }
+    return VPACK_ERROR ^ VPACK_ARRAY_404;
+}
+
+void
+vpack_free(void* vpack_ptr)
+{
+    struct void_packed* vpack = (struct void_packed*)vpack_ptr;
+    varr_free(&vpack->blocks);
+    varr_free(&vpack->words);
+    vpack->tail_size = 0;
+    vpack->size = 0;
+}
@@ -0,0 +1,145 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#ifndef VPK_VOID_PACKED_H
+#define VPK_VOID_PACKED_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "void_array.h"
+
+/**
+ * Error Codes
+ */
+#define VPACK_SUCCESS               0
+#define VPACK_ERROR                 1
+#define VPACK_ARRAY_404             2
+#define VPACK_INDEX_OUT_OF_RANGE    3
+
+/**
+ * Amount of values per block
+ */
+#define VPACK_BLOCK                 128
+
+/**
+ * Value `i` of a block is packed into lane `i % VPACK_LANES`, the words of
+ * the lanes are interleaved. Decoding shifts and masks all lanes at once,
+ * which compilers turn into plain vector instructions (4 x 64 bit on AVX2).
+ */
+#define VPACK_LANES                 4
+
+/**
+ * Index entry of a sealed block
+ */
+struct vpack_block {
+    /** smallest value (frame of reference) or first value (delta) */
+    uint64_t base;
+    /** index of the block's first word in `words` */
+    unsigned long offset;
+    /** bits per packed value */
+    unsigned char bits;
+    /** whether the packed values are deltas to the value `VPACK_LANES` before */
+    unsigned char delta;
+};
+
+/**
+ * Void Packed Structure
+ * Read-optimized array of unsigned 64 bit integers.
+ * Values are appended to `tail`, every full block of `VPACK_BLOCK` values
+ * gets sealed: its values are stored relative to the smallest one
+ * (frame of reference) or, for ascending blocks with smaller gaps, as
+ * deltas to the value `VPACK_LANES` before, bit-packed with as many bits
+ * as the largest of them needs.
+ */
+struct void_packed {
+    /** `struct vpack_block` of every sealed block */
+    struct void_array blocks;
+    /** bit-packed values of all sealed blocks followed by `VPACK_LANES` zero words */
+    struct void_array words;
+    /** values not sealed yet */
+    uint64_t tail[VPACK_BLOCK];
+    /** amount of values in `tail` */
+    unsigned long tail_size;
+    /** amount of values */
+    unsigned long size;
+};
+
+/**
+ * Copies `n` values onto the end, sealing every block that fills.
+ *
+ * @param vpack Void Packed to append to
+ * @param values Array of `n` values
+ * @param n Amount of values
+ * @return Error Code
+ */
+int
+vpack_add(struct void_packed* vpack, const uint64_t* values, const unsigned long n);
+
+/**
+ * Decodes the value at `idx` in O(1) (frame of reference blocks)
+ * or O(`VPACK_BLOCK / VPACK_LANES`) (delta blocks).
+ *
+ * @param vpack Void Packed to get the value from
+ * @param idx Index of the value
+ * @param value Set to the value
+ * @return Error Code
+ */
+int
+vpack_get(const struct void_packed* vpack, const unsigned long idx, uint64_t* value);
+
+/**
+ * Decodes `n` values from `idx` on into `out`.
+ * Whole blocks are unpacked with branch-free loops over the lanes.
+ *
+ * @param vpack Void Packed to decode
+ * @param idx Index of the first value
+ * @param n Amount of values
+ * @param out Array of `n` values to decode into
+ * @return Error Code
+ */
+int
+vpack_decode(const struct void_packed* vpack, const unsigned long idx, const unsigned long n, uint64_t* out);
+
+/**
+ * Deletes all values.
+ *
+ * @param vpack Void Packed to clear
+ * @return Error Code
+ */
+int
+vpack_clear(struct void_packed* vpack);
+
+/**
+ * Initializes a Void Packed.
+ *
+ * @param vpack Void Packed to be initialized
+ * @param init_blocks Amount of blocks memory is allocated for
+ * @return Error Code (`VPACK_ERROR` if the memory couldn't be allocated, the array is still safe to use and free)
+ */
+int
+vpack_init(struct void_packed* vpack, const unsigned long init_blocks);
+
+/**
+ * Assumes `vpack_ptr` is of type `struct void_packed*`.
+ * Frees all allocated data of the Packed array.
+ *
+ * @param vpack_ptr Void Packed of which the content is to be freed
+ */
+void
+vpack_free(void* vpack_ptr);
+
+#endif /* VPK_VOID_PACKED_H */
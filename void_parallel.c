@@ -0,0 +1,361 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "void_parallel.h"
+
+#define VALUE(varray, idx) ((unsigned char*)varr_data(varray) + (varray)->value_size * (idx))
+
+/**
+ * Shared state of one parallel operation.
+ */
+struct vpar_job {
+    const struct void_array* src;
+    struct void_array* dst;
+    /** values per chunk */
+    size_t chunk_size;
+    /** one accumulator per chunk (reduce and scan) */
+    unsigned char* partials;
+    const void* identity;
+    void(*for_each_fn)(void*, void*);
+    void(*map_fn)(const void*, void*, void*);
+    void(*combine)(void*, const void*, void*);
+    void* arg;
+};
+
+/* Claims chunks from the own cursor first and steals from the others afterwards */
+static void
+vtpool_work(struct void_thread_pool* pool, size_t self)
+{
+    for (size_t v = 0; v < pool->thread_count; v++) {
+        struct vpar_cursor* cursor = pool->cursors + (self + v) % pool->thread_count;
+        for (;;) {
+            size_t chunk = __atomic_fetch_add(&cursor->next, 1, __ATOMIC_RELAXED);
+            if (chunk >= cursor->end) break;
+            pool->job_fn(pool->job_arg, chunk);
+        }
+    }
+}
+
+static void*
+vtpool_worker(void* thread_ptr)
+{
+    struct vtpool_thread* thread = (struct vtpool_thread*)thread_ptr;
+    struct void_thread_pool* pool = thread->pool;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stop && pool->generation == seen) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->stop) break;
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        vtpool_work(pool, thread->idx);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+void
+vtpool_run(struct void_thread_pool* pool, size_t chunks, void(*job_fn)(void*, size_t), void* arg)
+{
+    if (!pool || pool->thread_count < 2 || chunks < 2) {
+        for (size_t chunk = 0; chunk < chunks; chunk++) {
+            job_fn(arg, chunk);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&pool->run_lock);
+    pool->job_fn = job_fn;
+    pool->job_arg = arg;
+    for (size_t w = 0; w < pool->thread_count; w++) {
+        pool->cursors[w].next = chunks * w / pool->thread_count;
+        pool->cursors[w].end = chunks * (w + 1) / pool->thread_count;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->pending = pool->thread_count - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    vtpool_work(pool, pool->thread_count - 1);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    pthread_mutex_unlock(&pool->run_lock);
+}
+
+int
+vtpool_init(struct void_thread_pool* pool, size_t threads)
+{
+    if (pool) {
+        if (!threads) {
+            long online = sysconf(_SC_NPROCESSORS_ONLN);
+            threads = online > 0 ? (size_t)online : 1;
+        }
+        pool->thread_count = threads;
+        pool->generation = 0;
+        pool->pending = 0;
+        pool->stop = 0;
+        pool->job_fn = NULL;
+        pool->job_arg = NULL;
+        pool->cursors = (struct vpar_cursor*)calloc(threads, sizeof(struct vpar_cursor));
+        pool->threads = (struct vtpool_thread*)calloc(threads, sizeof(struct vtpool_thread));
+        if (!pool->cursors || !pool->threads) {
+            free(pool->cursors);
+            free(pool->threads);
+            return VPAR_ERROR;
+        }
+        pthread_mutex_init(&pool->run_lock, NULL);
+        pthread_mutex_init(&pool->lock, NULL);
+        pthread_cond_init(&pool->wake, NULL);
+        pthread_cond_init(&pool->done, NULL);
+
+        /* The last cursor belongs to the calling thread */
+        for (size_t t = 0; t + 1 < threads; t++) {
+            pool->threads[t].pool = pool;
+            pool->threads[t].idx = t;
+            if (pthread_create(&pool->threads[t].thread, NULL, vtpool_worker, pool->threads + t)) {
+                pool->thread_count = t + 1;
+                break;
+            }
+        }
+        return VPAR_SUCCESS;
+    }
+    return VPAR_ERROR ^ VPAR_POOL_404;
+}
+
+void
+vtpool_free(void* pool_ptr)
+{
+    struct void_thread_pool* pool = (struct void_thread_pool*)pool_ptr;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (size_t t = 0; t + 1 < pool->thread_count; t++) {
+        pthread_join(pool->threads[t].thread, NULL);
+    }
+    pthread_mutex_destroy(&pool->run_lock);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    pthread_cond_destroy(&pool->done);
+    free(pool->threads);
+    free(pool->cursors);
+    pool->threads = NULL;
+    pool->cursors = NULL;
+    pool->thread_count = 0;
+}
+
+size_t
+vpar_chunk_size(const struct void_thread_pool* pool, size_t n, size_t value_size)
+{
+    size_t threads = pool ? pool->thread_count : 1;
+    size_t min_values = value_size && value_size < VPAR_MIN_CHUNK_BYTES ? VPAR_MIN_CHUNK_BYTES / value_size : 1;
+    size_t chunk = (n + threads * VPAR_CHUNKS_PER_THREAD - 1) / (threads * VPAR_CHUNKS_PER_THREAD);
+    return chunk > min_values ? chunk : min_values;
+}
+
+static inline size_t
+vpar_chunk_end(const struct vpar_job* job, size_t chunk)
+{
+    size_t end = job->chunk_size * (chunk + 1);
+    return end < job->src->size ? end : job->src->size;
+}
+
+/* Prepares `dst` to receive `n` values without any further reallocation */
+static int
+vpar_prepare_dst(struct void_array* dst, size_t n)
+{
+    if (!dst->capacity) {
+        return VPAR_ERROR;
+    }
+    varr_clear(dst);
+    while (dst->capacity < n) {
+        unsigned long capacity = dst->capacity;
+        varr_expand(dst, 1);
+        if (dst->capacity == capacity) {
+            return VPAR_ERROR;
+        }
+    }
+    dst->size = n;
+    return VPAR_SUCCESS;
+}
+
+static void
+vpar_for_each_chunk(void* job_ptr, size_t chunk)
+{
+    struct vpar_job* job = (struct vpar_job*)job_ptr;
+    size_t end = vpar_chunk_end(job, chunk);
+    for (size_t i = job->chunk_size * chunk; i < end; i++) {
+        job->for_each_fn(VALUE(job->src, i), job->arg);
+    }
+}
+
+static void
+vpar_map_chunk(void* job_ptr, size_t chunk)
+{
+    struct vpar_job* job = (struct vpar_job*)job_ptr;
+    size_t end = vpar_chunk_end(job, chunk);
+    for (size_t i = job->chunk_size * chunk; i < end; i++) {
+        job->map_fn(VALUE(job->src, i), VALUE(job->dst, i), job->arg);
+    }
+}
+
+static void
+vpar_reduce_chunk(void* job_ptr, size_t chunk)
+{
+    struct vpar_job* job = (struct vpar_job*)job_ptr;
+    size_t end = vpar_chunk_end(job, chunk);
+    unsigned char* acc = job->partials + job->src->value_size * chunk;
+    memcpy(acc, job->identity, job->src->value_size);
+    for (size_t i = job->chunk_size * chunk; i < end; i++) {
+        job->combine(acc, VALUE(job->src, i), job->arg);
+    }
+}
+
+static void
+vpar_scan_chunk(void* job_ptr, size_t chunk)
+{
+    struct vpar_job* job = (struct vpar_job*)job_ptr;
+    size_t end = vpar_chunk_end(job, chunk);
+    unsigned char* acc = job->partials + job->src->value_size * chunk;
+    for (size_t i = job->chunk_size * chunk; i < end; i++) {
+        job->combine(acc, VALUE(job->src, i), job->arg);
+        memcpy(VALUE(job->dst, i), acc, job->src->value_size);
+    }
+}
+
+static inline size_t
+vpar_job_init(struct vpar_job* job, const struct void_thread_pool* pool, const struct void_array* src)
+{
+    memset(job, 0, sizeof(*job));
+    job->src = src;
+    job->chunk_size = vpar_chunk_size(pool, src->size, src->value_size);
+    return (src->size + job->chunk_size - 1) / job->chunk_size;
+}
+
+int
+vpar_for_each(struct void_thread_pool* pool, struct void_array* varray, void(*fn)(void*, void*), void* arg)
+{
+    if (varray) {
+        struct vpar_job job;
+        size_t chunks = vpar_job_init(&job, pool, varray);
+        job.for_each_fn = fn;
+        job.arg = arg;
+        vtpool_run(pool, chunks, vpar_for_each_chunk, &job);
+        return VPAR_SUCCESS;
+    }
+    return VPAR_ERROR ^ VPAR_ARRAY_404;
+}
+
+int
+vpar_map(struct void_thread_pool* pool, const struct void_array* src, struct void_array* dst, void(*fn)(const void*, void*, void*), void* arg)
+{
+    if (src && dst) {
+        struct vpar_job job;
+        size_t chunks = vpar_job_init(&job, pool, src);
+        if (vpar_prepare_dst(dst, src->size) != VPAR_SUCCESS) {
+            return VPAR_ERROR;
+        }
+        job.dst = dst;
+        job.map_fn = fn;
+        job.arg = arg;
+        vtpool_run(pool, chunks, vpar_map_chunk, &job);
+        return VPAR_SUCCESS;
+    }
+    return VPAR_ERROR ^ VPAR_ARRAY_404;
+}
+
+int
+vpar_reduce(struct void_thread_pool* pool, const struct void_array* varray, void* out, const void* identity, void(*combine)(void*, const void*, void*), void* arg)
+{
+    if (varray) {
+        struct vpar_job job;
+        size_t chunks = vpar_job_init(&job, pool, varray);
+        const size_t partials_size = varray->value_size * (chunks ? chunks : 1);
+        if (!(job.partials = (unsigned char*)valloc_alloc(varray->allocator, partials_size))) {
+            return VPAR_ERROR;
+        }
+        job.identity = identity;
+        job.combine = combine;
+        job.arg = arg;
+        vtpool_run(pool, chunks, vpar_reduce_chunk, &job);
+
+        memcpy(out, identity, varray->value_size);
+        for (size_t chunk = 0; chunk < chunks; chunk++) {
+            combine(out, job.partials + varray->value_size * chunk, arg);
+        }
+        valloc_free(varray->allocator, job.partials, partials_size);
+        return VPAR_SUCCESS;
+    }
+    return VPAR_ERROR ^ VPAR_ARRAY_404;
+}
+
+int
+vpar_scan(struct void_thread_pool* pool, const struct void_array* src, struct void_array* dst, const void* identity, void(*combine)(void*, const void*, void*), void* arg)
+{
+    if (src && dst) {
+        struct vpar_job job;
+        size_t chunks = vpar_job_init(&job, pool, src);
+        unsigned char* carry;
+
+        if (dst != src && (dst->value_size != src->value_size || vpar_prepare_dst(dst, src->size) != VPAR_SUCCESS)) {
+            return VPAR_ERROR;
+        }
+        if (!(job.partials = (unsigned char*)valloc_alloc(src->allocator, src->value_size * (chunks + 1)))) {
+            return VPAR_ERROR;
+        }
+        job.dst = dst;
+        job.identity = identity;
+        job.combine = combine;
+        job.arg = arg;
+
+        /* Totals of each chunk, turned into the exclusive prefix of each chunk */
+        vtpool_run(pool, chunks, vpar_reduce_chunk, &job);
+        carry = job.partials + src->value_size * chunks;
+        memcpy(carry, identity, src->value_size);
+        for (size_t chunk = 0; chunk < chunks; chunk++) {
+            unsigned char* partial = job.partials + src->value_size * chunk;
+            combine(carry, partial, arg);
+            memcpy(partial, carry, src->value_size);
+        }
+        memmove(job.partials + src->value_size, job.partials, src->value_size * chunks);
+        memcpy(job.partials, identity, src->value_size);
+
+        vtpool_run(pool, chunks, vpar_scan_chunk, &job);
+        valloc_free(src->allocator, job.partials, src->value_size * (chunks + 1));
+        return VPAR_SUCCESS;
+    }
+    return VPAR_ERROR ^ VPAR_ARRAY_404;
+}
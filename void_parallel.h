@@ -0,0 +1,211 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#ifndef VP_VOID_PARALLEL_H
+#define VP_VOID_PARALLEL_H
+
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "void_array.h"
+
+/**
+ * Error Codes
+ */
+#define VPAR_SUCCESS                0
+#define VPAR_ERROR                  1
+#define VPAR_POOL_404               2
+#define VPAR_ARRAY_404              3
+
+/**
+ * Minimal amount of bytes processed per chunk,
+ * so scheduling overhead stays small compared to the work.
+ */
+#ifndef VPAR_MIN_CHUNK_BYTES
+#define VPAR_MIN_CHUNK_BYTES        16384
+#endif
+
+/**
+ * Amount of chunks per thread, so threads which finish
+ * early can steal work of slower ones.
+ */
+#ifndef VPAR_CHUNKS_PER_THREAD
+#define VPAR_CHUNKS_PER_THREAD      8
+#endif
+
+#ifndef VPAR_CACHE_LINE
+#define VPAR_CACHE_LINE             64
+#endif
+
+/**
+ * Chunk Cursor Structure
+ * Range of chunks owned by one thread, other threads steal from it
+ * through the same atomic cursor once their own range is done.
+ */
+struct vpar_cursor {
+    /** next chunk to be claimed */
+    size_t next;
+    /** end of the owned chunk range */
+    size_t end;
+    unsigned char pad[VPAR_CACHE_LINE - 2 * sizeof(size_t)];
+};
+
+/**
+ * Worker Thread Structure
+ */
+struct vtpool_thread {
+    /** handle of the thread */
+    pthread_t thread;
+    /** pool the thread works for */
+    struct void_thread_pool* pool;
+    /** index of the thread's cursor */
+    size_t idx;
+};
+
+/**
+ * Void Thread Pool Structure
+ * The calling thread takes part in every job as the last worker.
+ */
+struct void_thread_pool {
+    /** spawned worker threads */
+    struct vtpool_thread* threads;
+    /** amount of workers including the calling thread */
+    size_t thread_count;
+    /** one chunk cursor per worker */
+    struct vpar_cursor* cursors;
+    /** serializes callers of `vtpool_run` around the single job slot */
+    pthread_mutex_t run_lock;
+    /** guards `generation`, `pending` and `stop` */
+    pthread_mutex_t lock;
+    /** signals workers a new job or shutdown */
+    pthread_cond_t wake;
+    /** signals the caller that all workers are done */
+    pthread_cond_t done;
+    /** counter of started jobs */
+    unsigned long generation;
+    /** amount of spawned workers still running the current job */
+    size_t pending;
+    /** set to shut workers down */
+    int stop;
+    /** function run on every chunk of the current job: (arg, chunk) */
+    void(*job_fn)(void*, size_t);
+    /** argument of the current job */
+    void* job_arg;
+};
+
+/**
+ * Runs `job_fn` once for every chunk in `[0, chunks)` spread over all
+ * workers of `pool` and returns once all chunks are done.
+ * Concurrent callers on the same pool take turns; `job_fn` must not
+ * call `vtpool_run` on the pool it runs on.
+ *
+ * @param pool Void Thread Pool to run on (NULL runs on the calling thread)
+ * @param chunks Amount of chunks
+ * @param job_fn Function to be called with `arg` and the chunk index
+ * @param arg Argument passed to `job_fn`
+ */
+void
+vtpool_run(struct void_thread_pool* pool, size_t chunks, void(*job_fn)(void*, size_t), void* arg);
+
+/**
+ * Initializes a Void Thread Pool and spawns its workers.
+ *
+ * @param pool Void Thread Pool to be initialized
+ * @param threads Amount of workers including the calling thread (0 for one per online core)
+ * @return Error Code
+ */
+int
+vtpool_init(struct void_thread_pool* pool, size_t threads);
+
+/**
+ * Assumes `pool_ptr` is of type `struct void_thread_pool*`.
+ * Joins all workers and frees the pool.
+ *
+ * @param pool_ptr Void Thread Pool to be freed
+ */
+void
+vtpool_free(void* pool_ptr);
+
+/**
+ * Returns the amount of values each chunk of a parallel operation
+ * over `n` values of `value_size` bytes covers on `pool`.
+ *
+ * @param pool Void Thread Pool the operation runs on (Nullable)
+ * @param n Amount of values
+ * @param value_size Size of values in bytes
+ * @return Values per chunk
+ */
+size_t
+vpar_chunk_size(const struct void_thread_pool* pool, size_t n, size_t value_size);
+
+/**
+ * Calls `fn` on every value of `varray` in parallel.
+ *
+ * @param pool Void Thread Pool to run on (Nullable)
+ * @param varray Void Array to iterate over
+ * @param fn Function called with a pointer to each value and `arg`
+ * @param arg Argument passed to `fn`
+ * @return Error Code
+ */
+int
+vpar_for_each(struct void_thread_pool* pool, struct void_array* varray, void(*fn)(void*, void*), void* arg);
+
+/**
+ * Clears `dst` and fills it with `fn` applied to every value of `src` in parallel.
+ * `dst` has to be initialized with a capacity of at least 1 and keeps its own `value_size`.
+ *
+ * @param pool Void Thread Pool to run on (Nullable)
+ * @param src Void Array to read values from
+ * @param dst Void Array to write results into
+ * @param fn Function called with the source value, the destination slot and `arg`
+ * @param arg Argument passed to `fn`
+ * @return Error Code
+ */
+int
+vpar_map(struct void_thread_pool* pool, const struct void_array* src, struct void_array* dst, void(*fn)(const void*, void*, void*), void* arg);
+
+/**
+ * Reduces all values of `varray` into `out` in parallel.
+ * `combine` has to be associative, partial results are combined in index order.
+ *
+ * @param pool Void Thread Pool to run on (Nullable)
+ * @param varray Void Array to reduce
+ * @param out Memory of size `varray->value_size` to store the result into
+ * @param identity Value which doesn't change an accumulator when combined
+ * @param combine Function combining the value of the second into the accumulator of the first parameter
+ * @param arg Argument passed to `combine`
+ * @return Error Code
+ */
+int
+vpar_reduce(struct void_thread_pool* pool, const struct void_array* varray, void* out, const void* identity, void(*combine)(void*, const void*, void*), void* arg);
+
+/**
+ * Stores the inclusive prefix scan of `src` into `dst` in parallel.
+ * `dst` may be `src`, otherwise it is cleared and needs the same `value_size`
+ * and a capacity of at least 1.
+ *
+ * @param pool Void Thread Pool to run on (Nullable)
+ * @param src Void Array to scan
+ * @param dst Void Array to store the prefixes into
+ * @param identity Value which doesn't change an accumulator when combined
+ * @param combine Function combining the value of the second into the accumulator of the first parameter
+ * @param arg Argument passed to `combine`
+ * @return Error Code
+ */
+int
+vpar_scan(struct void_thread_pool* pool, const struct void_array* src, struct void_array* dst, const void* identity, void(*combine)(void*, const void*, void*), void* arg);
+
+#endif /* VP_VOID_PARALLEL_H */
@@ -0,0 +1,238 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "void_ring.h"
+
+#define SLOT(vring, pos) ((unsigned char*)varr_data(&(vring)->storage) + (vring)->storage.value_size * ((pos) & (vring)->mask))
+#define SEQ(vring, pos) (((size_t*)varr_data(&(vring)->sequences)) + ((pos) & (vring)->mask))
+
+/* Copies `n` values between `data` and the slots starting at `pos`, wrapping around once if needed */
+static inline void
+vring_copy_in(struct void_ring* vring, size_t pos, const void* data, size_t n)
+{
+    size_t first = vring->mask + 1 - (pos & vring->mask);
+    if (first > n) first = n;
+    memcpy(SLOT(vring, pos), data, vring->storage.value_size * first);
+    memcpy(varr_data(&vring->storage), (const unsigned char*)data + vring->storage.value_size * first,
+            vring->storage.value_size * (n - first));
+}
+
+static inline void
+vring_copy_out(struct void_ring* vring, size_t pos, void* out, size_t n)
+{
+    size_t first = vring->mask + 1 - (pos & vring->mask);
+    if (first > n) first = n;
+    memcpy(out, SLOT(vring, pos), vring->storage.value_size * first);
+    memcpy((unsigned char*)out + vring->storage.value_size * first, varr_data(&vring->storage),
+            vring->storage.value_size * (n - first));
+}
+
+static size_t
+vring_spsc_push_n(struct void_ring* vring, const void* data, size_t n)
+{
+    size_t tail = __atomic_load_n(&vring->tail, __ATOMIC_RELAXED);
+    size_t capacity = vring->mask + 1;
+
+    if (capacity - (tail - vring->cached_head) < n) {
+        vring->cached_head = __atomic_load_n(&vring->head, __ATOMIC_ACQUIRE);
+        if (capacity - (tail - vring->cached_head) < n) {
+            n = capacity - (tail - vring->cached_head);
+        }
+    }
+    if (n) {
+        vring_copy_in(vring, tail, data, n);
+        __atomic_store_n(&vring->tail, tail + n, __ATOMIC_RELEASE);
+    }
+    return n;
+}
+
+static size_t
+vring_spsc_pop_n(struct void_ring* vring, void* out, size_t n)
+{
+    size_t head = __atomic_load_n(&vring->head, __ATOMIC_RELAXED);
+
+    if (vring->cached_tail - head < n) {
+        vring->cached_tail = __atomic_load_n(&vring->tail, __ATOMIC_ACQUIRE);
+        if (vring->cached_tail - head < n) {
+            n = vring->cached_tail - head;
+        }
+    }
+    if (n) {
+        vring_copy_out(vring, head, out, n);
+        __atomic_store_n(&vring->head, head + n, __ATOMIC_RELEASE);
+    }
+    return n;
+}
+
+/* Bounded MPMC queue after Dmitry Vyukov, each slot carries the position it is ready for */
+static int
+vring_mpmc_push(struct void_ring* vring, const void* data)
+{
+    size_t pos = __atomic_load_n(&vring->tail, __ATOMIC_RELAXED);
+    for (;;) {
+        size_t seq = __atomic_load_n(SEQ(vring, pos), __ATOMIC_ACQUIRE);
+        ptrdiff_t dif = (ptrdiff_t)(seq - pos);
+        if (dif == 0) {
+            if (__atomic_compare_exchange_n(&vring->tail, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (dif < 0) {
+            return VRING_ERROR ^ VRING_FULL;
+        } else {
+            pos = __atomic_load_n(&vring->tail, __ATOMIC_RELAXED);
+        }
+    }
+    memcpy(SLOT(vring, pos), data, vring->storage.value_size);
+    __atomic_store_n(SEQ(vring, pos), pos + 1, __ATOMIC_RELEASE);
+    return VRING_SUCCESS;
+}
+
+static int
+vring_mpmc_pop(struct void_ring* vring, void* out)
+{
+    size_t pos = __atomic_load_n(&vring->head, __ATOMIC_RELAXED);
+    for (;;) {
+        size_t seq = __atomic_load_n(SEQ(vring, pos), __ATOMIC_ACQUIRE);
+        ptrdiff_t dif = (ptrdiff_t)(seq - (pos + 1));
+        if (dif == 0) {
+            if (__atomic_compare_exchange_n(&vring->head, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (dif < 0) {
+            return VRING_ERROR ^ VRING_EMPTY;
+        } else {
+            pos = __atomic_load_n(&vring->head, __ATOMIC_RELAXED);
+        }
+    }
+    memcpy(out, SLOT(vring, pos), vring->storage.value_size);
+    __atomic_store_n(SEQ(vring, pos), pos + vring->mask + 1, __ATOMIC_RELEASE);
+    return VRING_SUCCESS;
+}
+
+int
+vring_push(struct void_ring* vring, const void* data)
+{
+    if (vring) {
+        if (vring->mode == VRING_MPMC) {
+            return vring_mpmc_push(vring, data);
+        }
+        return vring_spsc_push_n(vring, data, 1) ? VRING_SUCCESS : VRING_ERROR ^ VRING_FULL;
+    }
+    return VRING_ERROR ^ VRING_RING_404;
+}
+
+int
+vring_pop(struct void_ring* vring, void* out)
+{
+    if (vring) {
+        if (vring->mode == VRING_MPMC) {
+            return vring_mpmc_pop(vring, out);
+        }
+        return vring_spsc_pop_n(vring, out, 1) ? VRING_SUCCESS : VRING_ERROR ^ VRING_EMPTY;
+    }
+    return VRING_ERROR ^ VRING_RING_404;
+}
+
+size_t
+vring_push_n(struct void_ring* vring, const void* data, size_t n)
+{
+    size_t pushed = 0;
+    if (!vring) {
+        return 0;
+    }
+    if (vring->mode == VRING_SPSC) {
+        return vring_spsc_push_n(vring, data, n);
+    }
+    while (pushed < n && vring_mpmc_push(vring, (const unsigned char*)data + vring->storage.value_size * pushed) == VRING_SUCCESS) {
+        pushed++;
+    }
+    return pushed;
+}
+
+size_t
+vring_pop_n(struct void_ring* vring, void* out, size_t n)
+{
+    size_t popped = 0;
+    if (!vring) {
+        return 0;
+    }
+    if (vring->mode == VRING_SPSC) {
+        return vring_spsc_pop_n(vring, out, n);
+    }
+    while (popped < n && vring_mpmc_pop(vring, (unsigned char*)out + vring->storage.value_size * popped) == VRING_SUCCESS) {
+        popped++;
+    }
+    return popped;
+}
+
+size_t
+vring_size(const struct void_ring* vring)
+{
+    size_t head = __atomic_load_n(&vring->head, __ATOMIC_ACQUIRE);
+    size_t tail = __atomic_load_n(&vring->tail, __ATOMIC_ACQUIRE);
+    return tail - head > vring->mask + 1 ? 0 : tail - head;
+}
+
+int
+vring_init(struct void_ring* vring, size_t capacity, size_t value_size, int mode)
+{
+    if (vring) {
+        size_t pow2 = 1;
+        /* larger capacities have no power of two */
+        if (capacity > SIZE_MAX / 2) {
+            return VRING_ERROR;
+        }
+        while (pow2 < capacity) pow2 <<= 1;
+
+        memset(vring, 0, sizeof(*vring));
+        /* an explicit allocator keeps small rings off the small buffer next to `mask` and `mode` */
+        if (varr_init_alloc(&vring->storage, pow2, value_size, NULL, valloc_default()) != VARR_SUCCESS) {
+            return VRING_ERROR;
+        }
+        vring->storage.size = pow2;
+        vring->mask = pow2 - 1;
+        vring->mode = mode;
+        if (mode == VRING_MPMC) {
+            if (varr_init_alloc(&vring->sequences, pow2, sizeof(size_t), NULL, valloc_default()) != VARR_SUCCESS) {
+                varr_free(&vring->storage);
+                return VRING_ERROR;
+            }
+            for (size_t i = 0; i < pow2; i++) {
+                ((size_t*)varr_data(&vring->sequences))[i] = i;
+            }
+            vring->sequences.size = pow2;
+        }
+        return VRING_SUCCESS;
+    }
+    return VRING_ERROR ^ VRING_RING_404;
+}
+
+void
+vring_free(void* vring_ptr)
+{
+    struct void_ring* vring = (struct void_ring*)vring_ptr;
+    varr_free(&vring->storage);
+    if (vring->mode == VRING_MPMC) {
+        varr_free(&vring->sequences);
+    }
+    vring->mask = 0;
+    vring->head = vring->tail = 0;
+    vring->cached_head = vring->cached_tail = 0;
+}
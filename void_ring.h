@@ -0,0 +1,147 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#ifndef VR_VOID_RING_H
+#define VR_VOID_RING_H
+
+#include <stdlib.h>
+
+#include "void_array.h"
+
+/**
+ * Error Codes
+ */
+#define VRING_SUCCESS               0
+#define VRING_ERROR                 1
+#define VRING_RING_404              2
+#define VRING_FULL                  3
+#define VRING_EMPTY                 4
+
+/**
+ * Modes
+ */
+#define VRING_SPSC                  0 /** one producer and one consumer thread */
+#define VRING_MPMC                  1 /** any amount of producer and consumer threads */
+
+#ifndef VRING_CACHE_LINE
+#define VRING_CACHE_LINE            64
+#endif
+
+/**
+ * Void Ring Structure
+ * Bounded lock-free queue of fixed-size values.
+ * Producer and consumer positions live on separate cache lines, each
+ * group is padded by a whole line on both sides, so they stay apart
+ * wherever the structure is placed. Slots are always allocated on the heap.
+ */
+struct void_ring {
+    /** storage of all slots, `storage.capacity` is a power of two */
+    struct void_array storage;
+    /** sequence number of each slot (MPMC only) */
+    struct void_array sequences;
+    /** `storage.capacity - 1` */
+    size_t mask;
+    /** VRING_SPSC or VRING_MPMC */
+    int mode;
+    unsigned char pad0[VRING_CACHE_LINE];
+    /** position of the next value to be pushed */
+    size_t tail;
+    /** last seen `head` of the producer (SPSC only) */
+    size_t cached_head;
+    unsigned char pad1[VRING_CACHE_LINE];
+    /** position of the next value to be popped */
+    size_t head;
+    /** last seen `tail` of the consumer (SPSC only) */
+    size_t cached_tail;
+    unsigned char pad2[VRING_CACHE_LINE];
+};
+
+/**
+ * Copies `data` of size `vring->storage.value_size` into the ring.
+ *
+ * @param vring Void Ring to push to
+ * @param data Data to be copied into the Void Ring
+ * @return Error Code
+ */
+int
+vring_push(struct void_ring* vring, const void* data);
+
+/**
+ * Copies the oldest value of the ring into `out` and removes it.
+ *
+ * @param vring Void Ring to pop from
+ * @param out Memory of size `vring->storage.value_size` to copy the value into
+ * @return Error Code
+ */
+int
+vring_pop(struct void_ring* vring, void* out);
+
+/**
+ * Copies up to `n` values of `data` into the ring.
+ * SPSC rings reserve and publish all values at once,
+ * MPMC rings push one value after the other.
+ *
+ * @param vring Void Ring to push to
+ * @param data Array of values to be copied into the Void Ring
+ * @param n Amount of values in `data`
+ * @return Amount of values pushed (0 if `vring` is NULL)
+ */
+size_t
+vring_push_n(struct void_ring* vring, const void* data, size_t n);
+
+/**
+ * Copies up to `n` of the oldest values of the ring into `out` and removes them.
+ *
+ * @param vring Void Ring to pop from
+ * @param out Array of at least `n` values
+ * @param n Maximal amount of values to pop
+ * @return Amount of values popped (0 if `vring` is NULL)
+ */
+size_t
+vring_pop_n(struct void_ring* vring, void* out, size_t n);
+
+/**
+ * Returns the amount of stored values.
+ * Only a snapshot while other threads are pushing or popping.
+ *
+ * @param vring Void Ring to get the size of
+ * @return Amount of stored values
+ */
+size_t
+vring_size(const struct void_ring* vring);
+
+/**
+ * Initializes a Void Ring.
+ *
+ * @param vring Void Ring to be initialized
+ * @param capacity Minimal amount of storable values, rounded up to a power of two (at most `SIZE_MAX / 2`)
+ * @param value_size Size of Values to be saved (in Bytes)
+ * @param mode VRING_SPSC or VRING_MPMC
+ * @return Error Code
+ */
+int
+vring_init(struct void_ring* vring, size_t capacity, size_t value_size, int mode);
+
+/**
+ * Assumes `vring_ptr` is of type `struct void_ring*`.
+ * Frees all allocated data of the ring.
+ *
+ * @param vring_ptr Void Ring of which the content is to be freed
+ */
+void
+vring_free(void* vring_ptr);
+
+#endif /* VR_VOID_RING_H */
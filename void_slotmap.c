@@ -0,0 +1,170 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#include <stddef.h>
+#include <string.h>
+
+#include "void_slotmap.h"
+
+#define VSLOT_NONE UINT32_MAX
+
+#define SLOTS(vslot) ((struct vslot_slot*)varr_data(&(vslot)->slots))
+#define VALUE_SLOTS(vslot) ((uint32_t*)varr_data(&(vslot)->value_slots))
+
+#define HANDLE(slot, generation) (((uint64_t)(generation) << 32) | (slot))
+#define HANDLE_SLOT(handle) ((uint32_t)(handle))
+#define HANDLE_GENERATION(handle) ((uint32_t)((handle) >> 32))
+
+static inline struct vslot_slot*
+vslot_lookup(const struct void_slotmap* vslot, uint64_t handle)
+{
+    uint32_t slot = HANDLE_SLOT(handle);
+    if (slot < vslot->slots.size && SLOTS(vslot)[slot].generation == HANDLE_GENERATION(handle)) {
+        return SLOTS(vslot) + slot;
+    }
+    return NULL;
+}
+
+uint64_t
+vslot_insert(struct void_slotmap* vslot, const void* data)
+{
+    uint32_t slot;
+    uint32_t value_idx = (uint32_t)vslot->values.size;
+
+    if (value_idx == VSLOT_NONE) {
+        return VSLOT_NULL;
+    }
+    if (vslot->free_head != VSLOT_NONE) {
+        slot = vslot->free_head;
+        vslot->free_head = SLOTS(vslot)[slot].idx;
+    } else {
+        struct vslot_slot new_slot = { 0, 1 };
+        slot = (uint32_t)vslot->slots.size;
+        if (varr_add(&vslot->slots, &new_slot, 1) != VARR_SUCCESS) {
+            return VSLOT_NULL;
+        }
+    }
+    if (varr_add(&vslot->values, data, 1) == VARR_SUCCESS) {
+        if (varr_add(&vslot->value_slots, &slot, 1) == VARR_SUCCESS) {
+            SLOTS(vslot)[slot].idx = value_idx;
+            return HANDLE(slot, SLOTS(vslot)[slot].generation);
+        }
+        /* drops the copy without `value_free_fn`, `data` still belongs to the caller */
+        vslot->values.size--;
+        memset((unsigned char*)varr_data(&vslot->values) + vslot->values.value_size * value_idx, 0, vslot->values.value_size);
+    }
+    /* no handle to the slot was returned, so it keeps its generation */
+    SLOTS(vslot)[slot].idx = vslot->free_head;
+    vslot->free_head = slot;
+    return VSLOT_NULL;
+}
+
+void*
+vslot_get(const struct void_slotmap* vslot, uint64_t handle)
+{
+    struct vslot_slot* slot = vslot_lookup(vslot, handle);
+    if (slot) {
+        return (unsigned char*)varr_data(&vslot->values) + vslot->values.value_size * slot->idx;
+    }
+    return NULL;
+}
+
+uint64_t
+vslot_handle_at(const struct void_slotmap* vslot, unsigned long idx)
+{
+    if (idx < vslot->values.size) {
+        uint32_t slot = VALUE_SLOTS(vslot)[idx];
+        return HANDLE(slot, SLOTS(vslot)[slot].generation);
+    }
+    return VSLOT_NULL;
+}
+
+int
+vslot_erase(struct void_slotmap* vslot, uint64_t handle)
+{
+    if (vslot) {
+        struct vslot_slot* slot = vslot_lookup(vslot, handle);
+        uint32_t value_idx, last_idx;
+
+        if (!slot) {
+            return VSLOT_ERROR ^ VSLOT_STALE_HANDLE;
+        }
+        value_idx = slot->idx;
+        last_idx = (uint32_t)vslot->values.size - 1;
+        if (value_idx != last_idx) {
+            /* Moves the last value into the gap, so values stay dense */
+            uint32_t moved_slot = VALUE_SLOTS(vslot)[last_idx];
+            varr_replace(&vslot->values, value_idx,
+                    (unsigned char*)varr_data(&vslot->values) + vslot->values.value_size * last_idx, 1);
+            memset((unsigned char*)varr_data(&vslot->values) + vslot->values.value_size * last_idx, 0, vslot->values.value_size);
+            vslot->values.size--;
+            VALUE_SLOTS(vslot)[value_idx] = moved_slot;
+            SLOTS(vslot)[moved_slot].idx = value_idx;
+        } else {
+            varr_remove(&vslot->values, value_idx, 1);
+        }
+        vslot->value_slots.size--;
+
+        if (++slot->generation == 0) slot->generation = 1;
+        slot->idx = vslot->free_head;
+        vslot->free_head = HANDLE_SLOT(handle);
+        return VSLOT_SUCCESS;
+    }
+    return VSLOT_ERROR ^ VSLOT_MAP_404;
+}
+
+int
+vslot_clear(struct void_slotmap* vslot)
+{
+    if (vslot) {
+        for (unsigned long idx = 0; idx < vslot->value_slots.size; idx++) {
+            uint32_t slot = VALUE_SLOTS(vslot)[idx];
+            if (++SLOTS(vslot)[slot].generation == 0) SLOTS(vslot)[slot].generation = 1;
+            SLOTS(vslot)[slot].idx = vslot->free_head;
+            vslot->free_head = slot;
+        }
+        varr_clear(&vslot->values);
+        varr_clear(&vslot->value_slots);
+        return VSLOT_SUCCESS;
+    }
+    return VSLOT_ERROR ^ VSLOT_MAP_404;
+}
+
+int
+vslot_init(struct void_slotmap* vslot, unsigned long init_capacity, size_t value_size, void(*value_free_fn)(void*))
+{
+    if (vslot) {
+        int error = 0;
+        if (!init_capacity) init_capacity = 1;
+        /* arrays left without memory grow on the first insert */
+        error |= varr_init(&vslot->values, init_capacity, value_size, value_free_fn);
+        error |= varr_init(&vslot->value_slots, init_capacity, sizeof(uint32_t), NULL);
+        error |= varr_init(&vslot->slots, init_capacity, sizeof(struct vslot_slot), NULL);
+        vslot->free_head = VSLOT_NONE;
+        return error ? VSLOT_ERROR : VSLOT_SUCCESS;
+    }
+    return VSLOT_ERROR ^ VSLOT_MAP_404;
+}
+
+void
+vslot_free(void* vslot_ptr)
+{
+    struct void_slotmap* vslot = (struct void_slotmap*)vslot_ptr;
+    varr_free(&vslot->values);
+    varr_free(&vslot->value_slots);
+    varr_free(&vslot->slots);
+    vslot->free_head = VSLOT_NONE;
+}
@@ -0,0 +1,139 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#ifndef VS_VOID_SLOTMAP_H
+#define VS_VOID_SLOTMAP_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "void_array.h"
+
+/**
+ * Error Codes
+ */
+#define VSLOT_SUCCESS               0
+#define VSLOT_ERROR                 1
+#define VSLOT_MAP_404               2
+#define VSLOT_STALE_HANDLE          3
+
+/**
+ * Handle which never refers to a value
+ */
+#define VSLOT_NULL                  0
+
+/**
+ * Slot Structure
+ * Live slots point to their value, free slots to the next free slot.
+ */
+struct vslot_slot {
+    /** index of the value in `values` or next free slot */
+    uint32_t idx;
+    /** incremented whenever the value of the slot is erased */
+    uint32_t generation;
+};
+
+/**
+ * Void Slot Map Structure
+ * Values are stored densely, handles stay valid until their value is erased.
+ * A handle holds the generation in its upper and the slot in its lower 32 bits.
+ */
+struct void_slotmap {
+    /** densely stored values */
+    struct void_array values;
+    /** slot of each value in `values` */
+    struct void_array value_slots;
+    /** all slots of type `struct vslot_slot` */
+    struct void_array slots;
+    /** first free slot (UINT32_MAX if none) */
+    uint32_t free_head;
+};
+
+/**
+ * Copies `data` into the Slot Map.
+ *
+ * @param vslot Void Slot Map to insert into
+ * @param data Data of size `vslot->values.value_size` to be copied
+ * @return Handle of the value (VSLOT_NULL on failure)
+ */
+uint64_t
+vslot_insert(struct void_slotmap* vslot, const void* data);
+
+/**
+ * Returns pointer to the value of `handle`.
+ * The pointer is invalidated by the next insert or erase.
+ *
+ * @param vslot Void Slot Map to get the value from
+ * @param handle Handle returned by `vslot_insert`
+ * @return Pointer to the value (NULL if the handle is stale)
+ */
+void*
+vslot_get(const struct void_slotmap* vslot, uint64_t handle);
+
+/**
+ * Returns the handle of the value at `idx` of `vslot->values`.
+ *
+ * @param vslot Void Slot Map to get the handle from
+ * @param idx Index of the value in `vslot->values`
+ * @return Handle of the value (VSLOT_NULL if idx out of range)
+ */
+uint64_t
+vslot_handle_at(const struct void_slotmap* vslot, unsigned long idx);
+
+/**
+ * Erases the value of `handle` by moving the last value into its place.
+ * Deleted data is freed using `value_free_fn` if defined.
+ *
+ * @param vslot Void Slot Map to erase from
+ * @param handle Handle of the value
+ * @return Error Code
+ */
+int
+vslot_erase(struct void_slotmap* vslot, uint64_t handle);
+
+/**
+ * Erases all values, all handles become stale.
+ * Deleted data is freed using `value_free_fn` if defined.
+ *
+ * @param vslot Void Slot Map to be cleared
+ * @return Error Code
+ */
+int
+vslot_clear(struct void_slotmap* vslot);
+
+/**
+ * Initializes a Void Slot Map.
+ *
+ * @param vslot Void Slot Map to be initialized
+ * @param init_capacity Initial Memory Capacity of the Void Slot Map
+ * @param value_size Size of Values to be saved (in Bytes)
+ * @param value_free_fn Function to be called when freeing special datatypes (Nullable)
+ * @return Error Code (`VSLOT_ERROR` if the memory couldn't be allocated, the map is still safe to use and free)
+ */
+int
+vslot_init(struct void_slotmap* vslot, unsigned long init_capacity, size_t value_size, void(*value_free_fn)(void*));
+
+/**
+ * Assumes `vslot_ptr` is of type `struct void_slotmap*`.
+ * Frees all allocated data of the Slot Map.
+ * Deleted data is freed using `value_free_fn` if defined.
+ *
+ * @param vslot_ptr Void Slot Map of which the content is to be freed
+ */
+void
+vslot_free(void* vslot_ptr);
+
+#endif /* VS_VOID_SLOTMAP_H */
@@ -0,0 +1,217 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#include <stddef.h>
+#include <string.h>
+
+#include "void_table.h"
+
+#define COLUMN(vtab, col) ((struct void_array*)varr_data(&(vtab)->columns) + (col))
+#define FIELD(column, row) ((unsigned char*)varr_data(column) + (column)->value_size * (row))
+
+/* Grows every column to hold `n` more rows, so the following writes can't fail halfway */
+static int
+vtab_reserve(struct void_table* vtab, const unsigned long n)
+{
+    for (unsigned long c = 0; c < vtab->columns.size; c++) {
+        struct void_array* column = COLUMN(vtab, c);
+        unsigned long capacity = column->capacity, doublings = 0;
+        /* a column without memory gets a capacity of 1 on the first doubling */
+        while (capacity < vtab->rows + n) {
+            capacity = capacity ? capacity << 1 : 1;
+            doublings++;
+        }
+        varr_expand(column, doublings);
+        /* a failed reallocation leaves the capacity unchanged */
+        if (column->capacity < vtab->rows + n) {
+            return VTAB_ERROR;
+        }
+    }
+    return VTAB_SUCCESS;
+}
+
+struct void_array*
+vtab_column(const struct void_table* vtab, const unsigned long col)
+{
+    return col < vtab->columns.size ? COLUMN(vtab, col) : NULL;
+}
+
+void*
+vtab_column_data(const struct void_table* vtab, const unsigned long col)
+{
+    return col < vtab->columns.size ? varr_data(COLUMN(vtab, col)) : NULL;
+}
+
+int
+vtab_add(struct void_table* vtab, const void* const* fields, const unsigned long n)
+{
+    if (vtab) {
+        if (vtab_reserve(vtab, n) != VTAB_SUCCESS) {
+            return VTAB_ERROR;
+        }
+        for (unsigned long c = 0; c < vtab->columns.size && n; c++) {
+            varr_add(COLUMN(vtab, c), fields[c], n);
+        }
+        vtab->rows += n;
+        return VTAB_SUCCESS;
+    }
+    return VTAB_ERROR ^ VTAB_TABLE_404;
+}
+
+int
+vtab_add_records(struct void_table* vtab, const void* records, const unsigned long n, const size_t record_size, const size_t* offsets)
+{
+    if (vtab) {
+        if (vtab_reserve(vtab, n) != VTAB_SUCCESS) {
+            return VTAB_ERROR;
+        }
+        /* column by column, so every store goes to the same contiguous destination */
+        for (unsigned long c = 0; c < vtab->columns.size; c++) {
+            struct void_array* column = COLUMN(vtab, c);
+            const unsigned char* src = (const unsigned char*)records + offsets[c];
+            unsigned char* dst = FIELD(column, column->size);
+            for (unsigned long i = 0; i < n; i++) {
+                memcpy(dst + column->value_size * i, src + record_size * i, column->value_size);
+            }
+            column->size += n;
+        }
+        vtab->rows += n;
+        return VTAB_SUCCESS;
+    }
+    return VTAB_ERROR ^ VTAB_TABLE_404;
+}
+
+int
+vtab_insert(struct void_table* vtab, const unsigned long idx, const void* const* fields, const unsigned long n)
+{
+    if (vtab) {
+        if (idx > vtab->rows) {
+            return VTAB_ERROR ^ VTAB_INDEX_OUT_OF_RANGE;
+        }
+        if (idx == vtab->rows) {
+            return vtab_add(vtab, fields, n);
+        }
+        if (vtab_reserve(vtab, n) != VTAB_SUCCESS) {
+            return VTAB_ERROR;
+        }
+        for (unsigned long c = 0; c < vtab->columns.size && n; c++) {
+            varr_insert(COLUMN(vtab, c), idx, fields[c], n);
+        }
+        vtab->rows += n;
+        return VTAB_SUCCESS;
+    }
+    return VTAB_ERROR ^ VTAB_TABLE_404;
+}
+
+int
+vtab_remove(struct void_table* vtab, const unsigned long idx, const unsigned long n)
+{
+    if (vtab) {
+        if (idx + n > vtab->rows) {
+            return VTAB_ERROR ^ VTAB_INDEX_OUT_OF_RANGE;
+        }
+        for (unsigned long c = 0; c < vtab->columns.size && n; c++) {
+            varr_remove(COLUMN(vtab, c), idx, n);
+        }
+        vtab->rows -= n;
+        return VTAB_SUCCESS;
+    }
+    return VTAB_ERROR ^ VTAB_TABLE_404;
+}
+
+const void*
+vtab_get(const struct void_table* vtab, const unsigned long row, const unsigned long col)
+{
+    if (col < vtab->columns.size) {
+        return varr_get(COLUMN(vtab, col), row);
+    }
+    return NULL;
+}
+
+int
+vtab_set(struct void_table* vtab, const unsigned long row, const unsigned long col, const void* value)
+{
+    if (vtab) {
+        if (col >= vtab->columns.size) {
+            return VTAB_ERROR ^ VTAB_COLUMN_404;
+        }
+        if (row >= vtab->rows) {
+            return VTAB_ERROR ^ VTAB_INDEX_OUT_OF_RANGE;
+        }
+        memcpy(FIELD(COLUMN(vtab, col), row), value, COLUMN(vtab, col)->value_size);
+        return VTAB_SUCCESS;
+    }
+    return VTAB_ERROR ^ VTAB_TABLE_404;
+}
+
+int
+vtab_get_row(const struct void_table* vtab, const unsigned long row, void* const* out)
+{
+    if (vtab) {
+        if (row >= vtab->rows) {
+            return VTAB_ERROR ^ VTAB_INDEX_OUT_OF_RANGE;
+        }
+        for (unsigned long c = 0; c < vtab->columns.size; c++) {
+            memcpy(out[c], FIELD(COLUMN(vtab, c), row), COLUMN(vtab, c)->value_size);
+        }
+        return VTAB_SUCCESS;
+    }
+    return VTAB_ERROR ^ VTAB_TABLE_404;
+}
+
+int
+vtab_clear(struct void_table* vtab)
+{
+    if (vtab) {
+        for (unsigned long c = 0; c < vtab->columns.size; c++) {
+            varr_clear(COLUMN(vtab, c));
+        }
+        vtab->rows = 0;
+        return VTAB_SUCCESS;
+    }
+    return VTAB_ERROR ^ VTAB_TABLE_404;
+}
+
+int
+vtab_init(struct void_table* vtab, const unsigned long init_capacity, const unsigned long n_columns, const size_t* value_sizes)
+{
+    if (vtab) {
+        /* freeing the columns array frees every column with it */
+        varr_init(&vtab->columns, n_columns ? n_columns : 1, sizeof(struct void_array), varr_free);
+        vtab->rows = 0;
+        for (unsigned long c = 0; c < n_columns; c++) {
+            struct void_array column;
+            /* a column without memory still grows on the first write,
+               the explicit allocator keeps it off the small buffer so it can be copied */
+            varr_init_alloc(&column, init_capacity ? init_capacity : 1, value_sizes[c], NULL, valloc_default());
+            if (varr_add(&vtab->columns, &column, 1) != VARR_SUCCESS) {
+                varr_free(&column);
+                vtab_free(vtab);
+                return VTAB_ERROR;
+            }
+        }
+        return VTAB_SUCCESS;
+    }
+    return VTAB_ERROR ^ VTAB_TABLE_404;
+}
+
+void
+vtab_free(void* vtab_ptr)
+{
+    struct void_table* vtab = (struct void_table*)vtab_ptr;
+    varr_free(&vtab->columns);
+    vtab->rows = 0;
+}
@@ -0,0 +1,182 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#ifndef VTB_VOID_TABLE_H
+#define VTB_VOID_TABLE_H
+
+#include <stdlib.h>
+
+#include "void_array.h"
+
+/**
+ * Error Codes
+ */
+#define VTAB_SUCCESS                0
+#define VTAB_ERROR                  1
+#define VTAB_TABLE_404              2
+#define VTAB_COLUMN_404             3
+#define VTAB_INDEX_OUT_OF_RANGE     4
+
+/**
+ * Void Table Structure
+ * Columnar (struct of arrays) table, every field of a row is stored in the
+ * Void Array of its column. Scans over one column only touch that column's
+ * values, which lie contiguous in memory.
+ */
+struct void_table {
+    /** one `struct void_array` per column, all of them hold `rows` values */
+    struct void_array columns;
+    /** amount of rows */
+    unsigned long rows;
+};
+
+/**
+ * Returns the Void Array of column `col`.
+ *
+ * @param vtab Void Table to get the column from
+ * @param col Index of the column
+ * @return Void Array of the column (NULL if out of range)
+ */
+struct void_array*
+vtab_column(const struct void_table* vtab, const unsigned long col);
+
+/**
+ * Returns pointer to the contiguous values of column `col`,
+ * the value of row `i` is at `i * value_size` bytes.
+ *
+ * @param vtab Void Table to get the values from
+ * @param col Index of the column
+ * @return Pointer to the values (NULL if out of range)
+ */
+void*
+vtab_column_data(const struct void_table* vtab, const unsigned long col);
+
+/**
+ * Appends `n` rows. `fields[c]` points to `n` values of column `c`.
+ * Either all columns are appended or none.
+ *
+ * @param vtab Void Table to append to
+ * @param fields One array of `n` values per column
+ * @param n Amount of rows
+ * @return Error Code
+ */
+int
+vtab_add(struct void_table* vtab, const void* const* fields, const unsigned long n);
+
+/**
+ * Appends `n` records of `record_size` bytes, the field of column `c`
+ * is copied from `offsets[c]` bytes into each record.
+ * Converts arrays of structures into the columnar layout.
+ *
+ * @param vtab Void Table to append to
+ * @param records Array of `n` records
+ * @param n Amount of records
+ * @param record_size Size of a record in Bytes
+ * @param offsets Offset of every column's field in a record
+ * @return Error Code
+ */
+int
+vtab_add_records(struct void_table* vtab, const void* records, const unsigned long n, const size_t record_size, const size_t* offsets);
+
+/**
+ * Inserts `n` rows at row `idx`, following rows are pushed back.
+ * `fields[c]` points to `n` values of column `c`.
+ *
+ * @param vtab Void Table to insert into
+ * @param idx Row index to insert at
+ * @param fields One array of `n` values per column
+ * @param n Amount of rows
+ * @return Error Code
+ */
+int
+vtab_insert(struct void_table* vtab, const unsigned long idx, const void* const* fields, const unsigned long n);
+
+/**
+ * Removes the rows from `idx` to `idx + n` in all columns.
+ *
+ * @param vtab Void Table to remove from
+ * @param idx Index of the first row
+ * @param n Amount of rows
+ * @return Error Code
+ */
+int
+vtab_remove(struct void_table* vtab, const unsigned long idx, const unsigned long n);
+
+/**
+ * Returns pointer to the field of column `col` in row `row`.
+ *
+ * @param vtab Void Table to get the field from
+ * @param row Index of the row
+ * @param col Index of the column
+ * @return Pointer to the field (NULL if out of range)
+ */
+const void*
+vtab_get(const struct void_table* vtab, const unsigned long row, const unsigned long col);
+
+/**
+ * Copies `value` into the field of column `col` in row `row`.
+ *
+ * @param vtab Void Table to set the field in
+ * @param row Index of the row
+ * @param col Index of the column
+ * @param value Value to be copied
+ * @return Error Code
+ */
+int
+vtab_set(struct void_table* vtab, const unsigned long row, const unsigned long col, const void* value);
+
+/**
+ * Copies every field of row `row` into `out[c]` for each column `c`.
+ *
+ * @param vtab Void Table to get the row from
+ * @param row Index of the row
+ * @param out One destination per column
+ * @return Error Code
+ */
+int
+vtab_get_row(const struct void_table* vtab, const unsigned long row, void* const* out);
+
+/**
+ * Deletes all rows while keeping the columns.
+ *
+ * @param vtab Void Table to clear
+ * @return Error Code
+ */
+int
+vtab_clear(struct void_table* vtab);
+
+/**
+ * Initializes a Void Table with `n_columns` columns.
+ *
+ * @param vtab Void Table to be initialized
+ * @param init_capacity Initial amount of rows every column has memory for
+ * @param n_columns Amount of columns
+ * @param value_sizes Size of the values of every column in Bytes
+ * @return Error Code
+ */
+int
+vtab_init(struct void_table* vtab, const unsigned long init_capacity, const unsigned long n_columns, const size_t* value_sizes);
+
+/**
+ * Assumes `vtab_ptr` is of type `struct void_table*`.
+ * Frees all allocated data of the Table and its columns.
+ *
+ * @param vtab_ptr Void Table of which the content is to be freed
+ */
+void
+vtab_free(void* vtab_ptr);
+
+#endif /* VTB_VOID_TABLE_H */
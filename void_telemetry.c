@@ -0,0 +1,111 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#include <stddef.h>
+
+#include "void_telemetry.h"
+
+static const char* const family_names[VTELEM_FAMILIES] = {
+    "void_array", "void_dict", "void_vector", "void_cow"
+};
+
+static struct vtelem_counters counters[VTELEM_FAMILIES];
+static vtelem_hook_fn hook_fn = NULL;
+static void* hook_arg = NULL;
+
+#define COUNT(field, n) __atomic_add_fetch(&(field), (n), __ATOMIC_RELAXED)
+
+void
+vtelem_record(int family, int event, size_t old_size, size_t new_size)
+{
+    struct vtelem_counters* family_counters = counters + family;
+    vtelem_hook_fn hook = __atomic_load_n(&hook_fn, __ATOMIC_ACQUIRE);
+
+    switch (event) {
+    case VTELEM_EVENT_ALLOC:
+        COUNT(family_counters->allocations, 1);
+        COUNT(family_counters->bytes_allocated, new_size);
+        break;
+    case VTELEM_EVENT_REALLOC:
+        COUNT(family_counters->reallocations, 1);
+        if (new_size > old_size) {
+            COUNT(family_counters->bytes_allocated, new_size - old_size);
+        } else {
+            COUNT(family_counters->bytes_freed, old_size - new_size);
+        }
+        break;
+    default:
+        COUNT(family_counters->frees, 1);
+        COUNT(family_counters->bytes_freed, old_size);
+        break;
+    }
+    if (hook) {
+        hook(family, event, old_size, new_size, __atomic_load_n(&hook_arg, __ATOMIC_RELAXED));
+    }
+}
+
+void
+vtelem_record_move(int family, size_t bytes)
+{
+    COUNT(counters[family].bytes_moved, bytes);
+}
+
+void
+vtelem_set_hook(vtelem_hook_fn hook, void* arg)
+{
+    __atomic_store_n(&hook_arg, arg, __ATOMIC_RELAXED);
+    __atomic_store_n(&hook_fn, hook, __ATOMIC_RELEASE);
+}
+
+void
+vtelem_get(int family, struct vtelem_counters* out)
+{
+    const struct vtelem_counters* family_counters = counters + family;
+    out->allocations = __atomic_load_n(&family_counters->allocations, __ATOMIC_RELAXED);
+    out->reallocations = __atomic_load_n(&family_counters->reallocations, __ATOMIC_RELAXED);
+    out->frees = __atomic_load_n(&family_counters->frees, __ATOMIC_RELAXED);
+    out->bytes_allocated = __atomic_load_n(&family_counters->bytes_allocated, __ATOMIC_RELAXED);
+    out->bytes_freed = __atomic_load_n(&family_counters->bytes_freed, __ATOMIC_RELAXED);
+    out->bytes_moved = __atomic_load_n(&family_counters->bytes_moved, __ATOMIC_RELAXED);
+}
+
+void
+vtelem_reset(void)
+{
+    for (int family = 0; family < VTELEM_FAMILIES; family++) {
+        struct vtelem_counters* family_counters = counters + family;
+        __atomic_store_n(&family_counters->allocations, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&family_counters->reallocations, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&family_counters->frees, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&family_counters->bytes_allocated, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&family_counters->bytes_freed, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&family_counters->bytes_moved, 0, __ATOMIC_RELAXED);
+    }
+}
+
+void
+vtelem_dump(FILE* stream)
+{
+    fprintf(stream, "%-12s%12s%12s%12s%16s%16s%16s\n", "family", "allocs", "reallocs", "frees",
+            "bytes alloc'd", "bytes freed", "bytes moved");
+    for (int family = 0; family < VTELEM_FAMILIES; family++) {
+        struct vtelem_counters snapshot;
+        vtelem_get(family, &snapshot);
+        fprintf(stream, "%-12s%12zu%12zu%12zu%16zu%16zu%16zu\n", family_names[family],
+                snapshot.allocations, snapshot.reallocations, snapshot.frees,
+                snapshot.bytes_allocated, snapshot.bytes_freed, snapshot.bytes_moved);
+    }
+}
@@ -0,0 +1,134 @@
+/*
+    Copyright (C) 2022  Andre Schneider
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License Version 2.1 as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License Version 2.1 for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License Version 2.1 along with this library; if not,
+    write to <andre.schneider@outlook.at>.
+*/
+#ifndef VT_VOID_TELEMETRY_H
+#define VT_VOID_TELEMETRY_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Container Families
+ */
+#define VTELEM_ARRAY                0 /** void_array and everything built on it */
+#define VTELEM_DICT                 1
+#define VTELEM_VECTOR               2
+#define VTELEM_COW                  3
+#define VTELEM_FAMILIES             4
+
+/**
+ * Allocation Events
+ */
+#define VTELEM_EVENT_ALLOC          0
+#define VTELEM_EVENT_REALLOC        1
+#define VTELEM_EVENT_FREE           2
+
+/**
+ * Telemetry Counters Structure
+ * Counters of one container family since the last reset.
+ */
+struct vtelem_counters {
+    /** amount of fresh allocations, including small buffers spilling onto the heap */
+    size_t allocations;
+    /** amount of reallocations (expand or shrink) */
+    size_t reallocations;
+    /** amount of released allocations */
+    size_t frees;
+    /** bytes requested by allocations and grown reallocations */
+    size_t bytes_allocated;
+    /** bytes released by frees and shrunk reallocations */
+    size_t bytes_freed;
+    /** bytes moved inside containers to open or close gaps */
+    size_t bytes_moved;
+};
+
+/**
+ * Hook called on every allocation event of any container family.
+ * Arguments: (family, event, old_size, new_size, arg)
+ */
+typedef void(*vtelem_hook_fn)(int, int, size_t, size_t, void*);
+
+/**
+ * Containers record telemetry only if compiled with `VOID_TELEMETRY`,
+ * otherwise these expand to nothing and don't evaluate their arguments.
+ */
+#ifdef VOID_TELEMETRY
+#define VTELEM_ALLOC(family, size)              vtelem_record((family), VTELEM_EVENT_ALLOC, 0, (size))
+#define VTELEM_REALLOC(family, old_size, size)  vtelem_record((family), VTELEM_EVENT_REALLOC, (old_size), (size))
+#define VTELEM_FREE(family, size)               vtelem_record((family), VTELEM_EVENT_FREE, (size), 0)
+#define VTELEM_MOVE(family, bytes)              vtelem_record_move((family), (bytes))
+#else
+#define VTELEM_ALLOC(family, size)              ((void)0)
+#define VTELEM_REALLOC(family, old_size, size)  ((void)0)
+#define VTELEM_FREE(family, size)               ((void)0)
+#define VTELEM_MOVE(family, bytes)              ((void)0)
+#endif
+
+/**
+ * Counts an allocation event of `family` and passes it on to the hook.
+ * Thread-safe.
+ *
+ * @param family Container Family (VTELEM_ARRAY, ...)
+ * @param event Allocation Event (VTELEM_EVENT_ALLOC, ...)
+ * @param old_size Previous size of the allocation in bytes (0 for allocations)
+ * @param new_size New size of the allocation in bytes (0 for frees)
+ */
+void
+vtelem_record(int family, int event, size_t old_size, size_t new_size);
+
+/**
+ * Counts `bytes` moved inside a container of `family`.
+ * Thread-safe.
+ *
+ * @param family Container Family (VTELEM_ARRAY, ...)
+ * @param bytes Amount of bytes moved
+ */
+void
+vtelem_record_move(int family, size_t bytes);
+
+/**
+ * Sets the hook called on every allocation event.
+ *
+ * @param hook Function to be called (NULL to remove the hook)
+ * @param arg Argument passed on to `hook`
+ */
+void
+vtelem_set_hook(vtelem_hook_fn hook, void* arg);
+
+/**
+ * Copies the counters of `family` into `counters`.
+ *
+ * @param family Container Family (VTELEM_ARRAY, ...)
+ * @param counters Structure to copy the counters into
+ */
+void
+vtelem_get(int family, struct vtelem_counters* counters);
+
+/**
+ * Sets the counters of all families to 0.
+ */
+void
+vtelem_reset(void);
+
+/**
+ * Prints the counters of all families as a table.
+ *
+ * @param stream Stream to print to
+ */
+void
+vtelem_dump(FILE* stream);
+
+#endif /* VT_VOID_TELEMETRY_H */
@@ -3,48 +3,70 @@
 #include <string.h>
 
 #include "void_vector.h"
+#include "void_telemetry.h"
 
 // ASSERTION MACROS
-#define ASSERT_NULL(ptr, name) assert(ptr != NULL && name " is `NULL`.") 
+#define ASSERT_NULL(ptr, name) assert(ptr != NULL && name " is `NULL`.")
 
 // HELPER MACROS
 #define GET_PTR(vec, idx) (((unsigned char*)vec->data) + vec->t_size * (idx))
 #define TAIL(vec) (((unsigned char*)vec->data) + vec->t_size * vec->count)
 
-typedef struct void_vector vvec;
+// Grows the capacity until `count` more elements fit
+static void vvec_reserve(vvec* vec, size_t count) {
+  unsigned int pow;
+  for (pow = 0; vec->count + count > vec->capacity << pow; pow++);
+  vvec_grow_cap(vec, pow);
+}
 
-inline void vvec_grow_cap(vvec* vec, unsigned int times) {
+void vvec_grow_cap(vvec* vec, unsigned int times) {
+  ASSERT_NULL(vec, "`void_vector`");
   assert(vec->capacity > 0 && "void_vector has not been initialized.");
 
   if (times > 0) {
-    vec->capacity >>= times;
-    vec->data = realloc(vec->data, vec->t_size * vec->capacity);
+    size_t old_capacity = vec->capacity;
+    void* data = valloc_realloc(vec->allocator, vec->data,
+                                vec->t_size * old_capacity,
+                                vec->t_size * (old_capacity << times));
+    assert(data != NULL && "Out of memory.");
+    VTELEM_REALLOC(VTELEM_VECTOR, vec->t_size * old_capacity, vec->t_size * (old_capacity << times));
+    vec->data = data;
+    vec->capacity = old_capacity << times;
   }
 }
 
-inline vvec* vvec_init_cap(vvec* vec, size_t type_size, size_t capacity) {
+vvec* vvec_init_alloc(vvec* vec, size_t type_size, size_t capacity,
+                      const struct void_allocator* allocator) {
   ASSERT_NULL(vec, "`void_vector`");
   assert(type_size > 0 && "`type_size` can't be smaller than `1`.");
   assert(capacity > 0 && "`capacity` can't be smaller than `1`.");
 
-  vec->data = calloc(capacity, type_size);
+  vec->allocator = allocator ? allocator : valloc_default();
+  vec->data = valloc_alloc(vec->allocator, capacity * type_size);
+  if (vec->data != NULL) {
+    VTELEM_ALLOC(VTELEM_VECTOR, capacity * type_size);
+  }
   vec->capacity = capacity;
   vec->count = 0;
   vec->t_size = type_size;
   return vec;
 }
 
-inline vvec* vvec_init(vvec* vec, size_t type_size) {
+vvec* vvec_init_cap(vvec* vec, size_t type_size, size_t capacity) {
+  return vvec_init_alloc(vec, type_size, capacity, NULL);
+}
+
+vvec* vvec_init(vvec* vec, size_t type_size) {
   return vvec_init_cap(vec, type_size, 1);
 }
 
-inline bool vvec_empty(vvec* vec) {
+bool vvec_empty(vvec* vec) {
   ASSERT_NULL(vec, "`void_vector`");
 
-  return vec->data == NULL;
+  return vec->count == 0;
 }
 
-inline void vvec_clear(vvec* vec) {
+void vvec_clear(vvec* vec) {
   ASSERT_NULL(vec, "`void_vector`");
 
   if (!vvec_empty(vec)) {
@@ -53,93 +75,118 @@ inline void vvec_clear(vvec* vec) {
   }
 }
 
-inline void* vvec_front(vvec* vec) {
+void* vvec_front(vvec* vec) {
   ASSERT_NULL(vec, "`void_vector`");
+  assert(!vvec_empty(vec) && "void_vector is empty.");
 
   return vec->data;
 }
 
-inline void* vvec_front(vvec* vec) {
+void* vvec_back(vvec* vec) {
   ASSERT_NULL(vec, "`void_vector`");
+  assert(!vvec_empty(vec) && "void_vector is empty.");
 
   return TAIL(vec) - vec->t_size;
 }
 
-inline void* vvec_at(vvec* vec, size_t idx) {
+void* vvec_at(vvec* vec, size_t idx) {
   ASSERT_NULL(vec, "`void_vector`");
   assert(idx < vec->count && "Index out-of-range.");
 
   return GET_PTR(vec, idx);
 }
 
-inline void* vvec_insert(vvec* vec, size_t pos, void* data, size_t count) {
+void* vvec_insert(vvec* vec, size_t pos, void* data, size_t count) {
   ASSERT_NULL(vec, "`void_vector`");
+  ASSERT_NULL(data, "`data`");
+  assert(pos <= vec->count && "Index out-of-range.");
 
-  unsigned int pow;
-  for (pow = 0; vec->count + count > vec->capacity >> pow; pow++);
-  vvec_grow_cap(vec, pow);
+  vvec_reserve(vec, count);
 
   memmove(GET_PTR(vec, pos + count),
           GET_PTR(vec, pos),
-          vec->t_size * count);
+          vec->t_size * (vec->count - pos));
+  VTELEM_MOVE(VTELEM_VECTOR, vec->t_size * (vec->count - pos));
   memcpy(GET_PTR(vec, pos), data, vec->t_size * count);
   vec->count += count;
   return GET_PTR(vec, pos);
 }
 
-inline void* vvec_erase(vvec* vec, void* to_del) {
-  ASSERT_NULL(vec, "`void_vector`");
-  assert(to_del >= vec->data && to_del < TAIL(vec) && "Pointer or Index out-of-range.");
-
-  memmove(to_del, ((unsigned char*)to_del) + vec->t_size, (TAIL(vec) - ((unsigned char*)to_del)) + vec->t_size);
-  memset(TAIL(vec) - vec->t_size, 0, vec->t_size);
-  vec->count--;
-  return to_del;
+void* vvec_erase(vvec* vec, void* to_del) {
+  return vvec_erase_range(vec, to_del, ((unsigned char*)to_del) + vec->t_size);
 }
 
-inline void* vvec_erase_idx(vvec* vec, size_t idx) {
+void* vvec_erase_idx(vvec* vec, size_t idx) {
   return vvec_erase(vec, GET_PTR(vec, idx));
 }
 
-inline void* vvec_erase_range(vvec* vec, void* first, void* last) {
-  // TODO: Implement
+void* vvec_erase_range(vvec* vec, void* first, void* last) {
+  ASSERT_NULL(vec, "`void_vector`");
+  assert((unsigned char*)first >= (unsigned char*)vec->data && (unsigned char*)first <= (unsigned char*)last
+         && (unsigned char*)last <= TAIL(vec) && "Pointer or Index out-of-range.");
+
+  size_t bytes = ((unsigned char*)last) - ((unsigned char*)first);
+  memmove(first, last, TAIL(vec) - ((unsigned char*)last));
+  VTELEM_MOVE(VTELEM_VECTOR, TAIL(vec) - ((unsigned char*)last));
+  memset(TAIL(vec) - bytes, 0, bytes);
+  vec->count -= bytes / vec->t_size;
+  return first;
 }
 
-inline void* vvec_erase_range_idx(vvec* vec, size_t first_idx, size_t last_idx) {
-  // TODO: Implement
+void* vvec_erase_range_idx(vvec* vec, size_t first_idx, size_t last_idx) {
+  return vvec_erase_range(vec, GET_PTR(vec, first_idx), GET_PTR(vec, last_idx));
 }
 
-inline void vvec_push_back(vvec* vec, const void* push_data, size_t count) {
+void* vvec_swap_remove(vvec* vec, size_t idx) {
+  ASSERT_NULL(vec, "`void_vector`");
+  assert(idx < vec->count && "Index out-of-range.");
+
+  unsigned char* last = TAIL(vec) - vec->t_size;
+  if (GET_PTR(vec, idx) != last) {
+    memcpy(GET_PTR(vec, idx), last, vec->t_size);
+  }
+  memset(last, 0, vec->t_size);
+  vec->count--;
+  return GET_PTR(vec, idx);
+}
+
+void vvec_push_back(vvec* vec, const void* push_data, size_t count) {
   ASSERT_NULL(vec, "`void_vector`");
   ASSERT_NULL(push_data, "`push_data`");
 
-  unsigned int pow;
-  for (pow = 0; vec->count + count > vec->capacity >> pow; pow++);
-  vvec_grow_cap(vec, pow);
+  vvec_reserve(vec, count);
 
   memcpy(TAIL(vec), push_data, vec->t_size * count);
   vec->count += count;
 }
 
-void vvec_emplace_back(vvec* vec, ) {
-  
+void* vvec_emplace_back(vvec* vec) {
+  ASSERT_NULL(vec, "`void_vector`");
+
+  vvec_reserve(vec, 1);
+
+  vec->count++;
+  return TAIL(vec) - vec->t_size;
 }
 
 void vvec_pop_back(vvec* vec) {
   ASSERT_NULL(vec, "`void_vector`");
+  assert(!vvec_empty(vec) && "void_vector is empty.");
 
-  memset(TAIL(vec) - vec->t_size, 0, vec->t_size);
+  vec->count--;
+  memset(TAIL(vec), 0, vec->t_size);
 }
 
-inline void vvec_free(vvec* vec) {
+void vvec_free(vvec* vec) {
   ASSERT_NULL(vec, "`void_vector`");
 
-  if (!vvec_empty(vec)) {
-    free(vec->data);
+  if (vec->data != NULL) {
+    valloc_free(vec->allocator, vec->data, vec->t_size * vec->capacity);
+    VTELEM_FREE(VTELEM_VECTOR, vec->t_size * vec->capacity);
   }
   vec->data = NULL;
   vec->capacity = 0;
   vec->count = 0;
   vec->t_size = 0;
+  vec->allocator = NULL;
 }
-
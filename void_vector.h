@@ -1,13 +1,123 @@
 #ifndef VOID_VECTOR_H
 #define VOID_VECTOR_H
 
+#include <stdbool.h>
 #include <stdlib.h>
 
+#include "void_alloc.h"
+
 struct void_vector {
   void* data;
   size_t capacity;
   size_t count;
   size_t t_size;
+  const struct void_allocator* allocator;
 };
 
+typedef struct void_vector vvec;
+
+/**
+ * Doubles the capacity of `vec` `times` times.
+ */
+void vvec_grow_cap(vvec* vec, unsigned int times);
+
+/**
+ * Initializes `vec` for elements of `type_size` bytes with room for
+ * `capacity` elements, memory is managed by `allocator` (NULL for the default).
+ */
+vvec* vvec_init_alloc(vvec* vec, size_t type_size, size_t capacity,
+                      const struct void_allocator* allocator);
+
+/**
+ * Initializes `vec` with room for `capacity` elements.
+ */
+vvec* vvec_init_cap(vvec* vec, size_t type_size, size_t capacity);
+
+/**
+ * Initializes `vec` with room for one element.
+ */
+vvec* vvec_init(vvec* vec, size_t type_size);
+
+/**
+ * Returns whether `vec` holds no elements.
+ */
+bool vvec_empty(vvec* vec);
+
+/**
+ * Removes all elements, keeps the capacity.
+ */
+void vvec_clear(vvec* vec);
+
+/**
+ * Returns pointer to the first element.
+ */
+void* vvec_front(vvec* vec);
+
+/**
+ * Returns pointer to the last element.
+ */
+void* vvec_back(vvec* vec);
+
+/**
+ * Returns pointer to the element at `idx`.
+ */
+void* vvec_at(vvec* vec, size_t idx);
+
+/**
+ * Copies `count` elements of `data` in front of the element at `pos`
+ * and returns pointer to the first inserted element.
+ */
+void* vvec_insert(vvec* vec, size_t pos, void* data, size_t count);
+
+/**
+ * Removes the element `to_del` points to, following elements move one to the left.
+ * Returns pointer to the element now at its position.
+ */
+void* vvec_erase(vvec* vec, void* to_del);
+
+/**
+ * Removes the element at `idx`, see `vvec_erase`.
+ */
+void* vvec_erase_idx(vvec* vec, size_t idx);
+
+/**
+ * Removes the elements in [`first`, `last`) with a single move of the tail.
+ * Returns pointer to the element now at `first`.
+ */
+void* vvec_erase_range(vvec* vec, void* first, void* last);
+
+/**
+ * Removes the elements in [`first_idx`, `last_idx`), see `vvec_erase_range`.
+ */
+void* vvec_erase_range_idx(vvec* vec, size_t first_idx, size_t last_idx);
+
+/**
+ * Removes the element at `idx` in O(1) by moving the last element into
+ * its place, thus not preserving the order.
+ * Returns pointer to the element now at `idx`.
+ */
+void* vvec_swap_remove(vvec* vec, size_t idx);
+
+/**
+ * Copies `count` elements of `push_data` to the end of `vec`.
+ */
+void vvec_push_back(vvec* vec, const void* push_data, size_t count);
+
+/**
+ * Appends an element without copying anything into it and returns
+ * pointer to it, so it can be constructed in place.
+ * The pointer is invalidated by the next growth of `vec`.
+ */
+void* vvec_emplace_back(vvec* vec);
+
+/**
+ * Removes the last element.
+ */
+void vvec_pop_back(vvec* vec);
+
+/**
+ * Frees the memory of `vec`.
+ */
+void vvec_free(vvec* vec);
+
 #endif